@@ -0,0 +1,323 @@
+/*
+ * Copyright (c) 2014 David Wicks, sansumbrella.com
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include "Easing.h"
+#include "detail/Float4.hpp"
+#include <type_traits>
+
+///
+/// \file
+/// Evaluates ease functions over arrays of normalized times.
+/// The functors from Easing.h run four times at once with branch-free kernels.
+/// Kernels use SSE2 when the compiler targets it and plain arrays elsewhere;
+/// there are no wider (AVX) kernels and no runtime dispatch.
+/// Their transcendental functions use polynomial approximations that stay
+/// within BatchEaseTolerance of the scalar eases.
+///
+/// Only StaticRampTo::getValues() calls these kernels, so they are reached through
+/// StaticRampTo phrases (Sequence::rampTo(), MotionOptions::staticRampTo()) sampled
+/// with Sequence::getValues() or played by a StaggeredMotion. RampTo holds its ease
+/// as a std::function, so its getValues() eases one time at a time, and Timelines
+/// evaluate each Motion's phrase separately.
+/// Batched results may differ slightly from the scalar getValue() at the same times.
+///
+
+namespace choreograph
+{
+
+/// Largest difference between an ease evaluated by easeBatch() and the same ease called directly.
+/// Polynomial eases usually match exactly; the Sine, Expo, Elastic, and Atan eases may not.
+const float BatchEaseTolerance = 1.0e-5f;
+
+namespace detail
+{
+
+//=================================================
+// Branch-free mirrors of the Easing.h equations.
+//=================================================
+
+inline Float4 easeOutIn4( Float4 t, Float4 out_half, Float4 in_half ) { return select( t < 0.5f, out_half / 2.0f, in_half / 2.0f + 0.5f ); }
+
+inline Float4 easeInQuad4( Float4 t ) { return t*t; }
+inline Float4 easeOutQuad4( Float4 t ) { return -t * ( t - 2.0f ); }
+inline Float4 easeInOutQuad4( Float4 t )
+{
+  t = t * 2.0f;
+  auto u = t - 1.0f;
+  return select( t < 1.0f, 0.5f * t * t, -0.5f * ((u)*(u-2.0f) - 1.0f) );
+}
+inline Float4 easeOutInQuad4( Float4 t ) { return easeOutIn4( t, easeOutQuad4( t*2.0f ), easeInQuad4( (2.0f*t)-1.0f ) ); }
+
+inline Float4 easeInCubic4( Float4 t ) { return t*t*t; }
+inline Float4 easeOutCubic4( Float4 t ) { t = t - 1.0f; return t*t*t + 1.0f; }
+inline Float4 easeInOutCubic4( Float4 t )
+{
+  t = t * 2.0f;
+  auto u = t - 2.0f;
+  return select( t < 1.0f, 0.5f * t*t*t, 0.5f*(u*u*u + 2.0f) );
+}
+inline Float4 easeOutInCubic4( Float4 t ) { return easeOutIn4( t, easeOutCubic4( 2.0f * t ), easeInCubic4( 2.0f*t - 1.0f ) ); }
+
+inline Float4 easeInQuart4( Float4 t ) { return t*t*t*t; }
+inline Float4 easeOutQuart4( Float4 t ) { t = t - 1.0f; return -(t*t*t*t - 1.0f); }
+inline Float4 easeInOutQuart4( Float4 t )
+{
+  t = t * 2.0f;
+  auto u = t - 2.0f;
+  return select( t < 1.0f, 0.5f*t*t*t*t, -0.5f * (u*u*u*u - 2.0f) );
+}
+inline Float4 easeOutInQuart4( Float4 t ) { return easeOutIn4( t, easeOutQuart4( 2.0f*t ), easeInQuart4( 2.0f*t-1.0f ) ); }
+
+inline Float4 easeInQuint4( Float4 t ) { return t*t*t*t*t; }
+inline Float4 easeOutQuint4( Float4 t ) { t = t - 1.0f; return t*t*t*t*t + 1.0f; }
+inline Float4 easeInOutQuint4( Float4 t )
+{
+  t = t * 2.0f;
+  auto u = t - 2.0f;
+  return select( t < 1.0f, 0.5f*t*t*t*t*t, 0.5f*(u*u*u*u*u + 2.0f) );
+}
+inline Float4 easeOutInQuint4( Float4 t ) { return easeOutIn4( t, easeOutQuint4( 2.0f*t ), easeInQuint4( 2.0f*t - 1.0f ) ); }
+
+inline Float4 easeInSine4( Float4 t ) { return -cosApprox( t * (float)PI / 2.0f ) + 1.0f; }
+inline Float4 easeOutSine4( Float4 t ) { return sinApprox( t * (float)PI / 2.0f ); }
+inline Float4 easeInOutSine4( Float4 t ) { return -0.5f * ( cosApprox( (float)PI * t ) - 1.0f ); }
+inline Float4 easeOutInSine4( Float4 t ) { return easeOutIn4( t, easeOutSine4( 2.0f * t ), easeInSine4( 2.0f*t - 1.0f ) ); }
+
+inline Float4 easeInExpo4( Float4 t ) { return select( t == 0.0f, 0.0f, exp2Approx( 10.0f * (t - 1.0f) ) ); }
+inline Float4 easeOutExpo4( Float4 t ) { return select( t == 1.0f, 1.0f, -exp2Approx( -10.0f * t ) + 1.0f ); }
+inline Float4 easeInOutExpo4( Float4 t )
+{
+  auto u = t * 2.0f;
+  auto eased = select( u < 1.0f, 0.5f * exp2Approx( 10.0f * (u - 1.0f) ), 0.5f * ( - exp2Approx( -10.0f * (u - 1.0f) ) + 2.0f ) );
+  return select( t == 0.0f, 0.0f, select( t == 1.0f, 1.0f, eased ) );
+}
+inline Float4 easeOutInExpo4( Float4 t ) { return easeOutIn4( t, easeOutExpo4( 2.0f * t ), easeInExpo4( 2.0f * t - 1.0f ) ); }
+
+inline Float4 easeInCirc4( Float4 t ) { return -( sqrt4( 1.0f - t*t ) - 1.0f ); }
+inline Float4 easeOutCirc4( Float4 t ) { t = t - 1.0f; return sqrt4( 1.0f - t*t ); }
+inline Float4 easeInOutCirc4( Float4 t )
+{
+  t = t * 2.0f;
+  auto u = t - 2.0f;
+  return select( t < 1.0f, -0.5f * (sqrt4( 1.0f - t*t ) - 1.0f), 0.5f * (sqrt4( 1.0f - u*u ) + 1.0f) );
+}
+inline Float4 easeOutInCirc4( Float4 t ) { return easeOutIn4( t, easeOutCirc4( 2.0f*t ), easeInCirc4( 2.0f*t - 1.0f ) ); }
+
+inline Float4 easeInBack4( Float4 t, float s ) { return t * t * ((s+1)*t - s); }
+inline Float4 easeOutBack4( Float4 t, float s ) { t = t - 1.0f; return (t*t*((s+1)*t + s) + 1.0f); }
+inline Float4 easeInOutBack4( Float4 t, float s )
+{
+  t = t * 2.0f;
+  s *= 1.525f;
+  auto u = t - 2.0f;
+  return select( t < 1.0f, 0.5f*(t*t*((s+1)*t - s)), 0.5f*(u*u*((s+1)*u+ s) + 2.0f) );
+}
+inline Float4 easeOutInBack4( Float4 t, float s ) { return easeOutIn4( t, easeOutBack4( 2.0f*t, s ), easeInBack4( 2.0f*t - 1.0f, s ) ); }
+
+inline Float4 easeOutBounceHelper4( Float4 t, float c, float a )
+{
+  auto t1 = t;
+  auto t2 = t - (6/11.0f);
+  auto t3 = t - (9/11.0f);
+  auto t4 = t - (21/22.0f);
+  auto v1 = c*( 7.5625f*t1*t1);
+  auto v2 = -a * (1.0f - (7.5625f*t2*t2 + 0.75f)) + c;
+  auto v3 = -a * (1.0f - (7.5625f*t3*t3 + 0.9375f)) + c;
+  auto v4 = -a * (1.0f - (7.5625f*t4*t4 + 0.984375f)) + c;
+  auto v = select( t < (4/11.0f), v1, select( t < (8/11.0f), v2, select( t < (10/11.0f), v3, v4 ) ) );
+  return select( t == 1.0f, c, v );
+}
+inline Float4 easeInBounce4( Float4 t, float a ) { return 1.0f - easeOutBounceHelper4( 1.0f-t, 1, a ); }
+inline Float4 easeOutBounce4( Float4 t, float a ) { return easeOutBounceHelper4( t, 1, a ); }
+inline Float4 easeInOutBounce4( Float4 t, float a ) { return select( t < 0.5f, easeInBounce4( 2.0f*t, a ) / 2.0f, select( t == 1.0f, 1.0f, easeOutBounce4( 2.0f*t - 1.0f, a )/2.0f + 0.5f ) ); }
+inline Float4 easeOutInBounce4( Float4 t, float a ) { return select( t < 0.5f, easeOutBounceHelper4( t*2.0f, 0.5f, a ), 1.0f - easeOutBounceHelper4( 2.0f - 2.0f*t, 0.5f, a ) ); }
+
+inline Float4 easeInElasticHelper4( Float4 t, float b, float c, float d, float a, float p )
+{
+  float s;
+  if( a < std::abs(c) ) {
+    a = c;
+    s = p / 4.0f;
+  }
+  else {
+    s = p / (2 * (float)PI) * std::asin( c / a );
+  }
+
+  auto t_adj = t / d;
+  auto done = t_adj == 1.0f;
+  t_adj = t_adj - 1.0f;
+  auto v = -( a * exp2Approx( 10.0f * t_adj ) * sinApprox( (t_adj * d-s) * (2 * (float)PI) / p )) + b;
+  return select( t == 0.0f, b, select( done, b+c, v ) );
+}
+inline Float4 easeOutElasticHelper4( Float4 t, float c, float a, float p )
+{
+  float s;
+  if( a < c ) {
+    a = c;
+    s = p / 4;
+  }
+  else {
+    s = p / ( 2 * (float)PI ) * std::asin( c / a );
+  }
+
+  auto v = a * exp2Approx( -10.0f*t ) * sinApprox( (t-s)*(2*(float)PI)/p ) + c;
+  return select( t == 0.0f, 0.0f, select( t == 1.0f, c, v ) );
+}
+inline Float4 easeInElastic4( Float4 t, float a, float p ) { return easeInElasticHelper4( t, 0, 1, 1, a, p ); }
+inline Float4 easeOutElastic4( Float4 t, float a, float p ) { return easeOutElasticHelper4( t, 1, a, p ); }
+inline Float4 easeInOutElastic4( Float4 t, float amplitude, float period )
+{
+  float s;
+  if( amplitude < 1 ) {
+    amplitude = 1;
+    s = period / 4;
+  }
+  else {
+    s = period / (2 * (float)PI) * std::asin( 1 / amplitude );
+  }
+
+  auto u = t * 2.0f;
+  auto in = -0.5f * ( amplitude * exp2Approx( 10.0f*(u-1.0f) ) * sinApprox( (u-1.0f-s)*(2*(float)PI)/period ));
+  auto out = amplitude * exp2Approx( -10.0f*(u-1.0f) ) * sinApprox( (u-1.0f-s)*(2*(float)PI)/period ) * 0.5f + 1.0f;
+  return select( t == 0.0f, 0.0f, select( u == 2.0f, 1.0f, select( u < 1.0f, in, out ) ) );
+}
+inline Float4 easeOutInElastic4( Float4 t, float a, float p ) { return select( t < 0.5f, easeOutElasticHelper4( t*2.0f, 0.5f, a, p ), easeInElasticHelper4( 2.0f*t - 1.0f, 0.5f, 0.5f, 1, a, p ) ); }
+
+//=================================================
+// Kernels by functor type.
+//=================================================
+
+/// Batch evaluation of an ease functor. Specialized for the functors in Easing.h.
+template<typename EaseT>
+struct BatchKernel { static const bool available = false; };
+
+struct BatchKernelAvailable { static const bool available = true; };
+
+template<> struct BatchKernel<EaseNone> : BatchKernelAvailable { static Float4 eval( const EaseNone &, Float4 t ) { return t; } };
+
+template<> struct BatchKernel<EaseInQuad> : BatchKernelAvailable { static Float4 eval( const EaseInQuad &, Float4 t ) { return easeInQuad4( t ); } };
+template<> struct BatchKernel<EaseOutQuad> : BatchKernelAvailable { static Float4 eval( const EaseOutQuad &, Float4 t ) { return easeOutQuad4( t ); } };
+template<> struct BatchKernel<EaseInOutQuad> : BatchKernelAvailable { static Float4 eval( const EaseInOutQuad &, Float4 t ) { return easeInOutQuad4( t ); } };
+template<> struct BatchKernel<EaseOutInQuad> : BatchKernelAvailable { static Float4 eval( const EaseOutInQuad &, Float4 t ) { return easeOutInQuad4( t ); } };
+
+template<> struct BatchKernel<EaseInCubic> : BatchKernelAvailable { static Float4 eval( const EaseInCubic &, Float4 t ) { return easeInCubic4( t ); } };
+template<> struct BatchKernel<EaseOutCubic> : BatchKernelAvailable { static Float4 eval( const EaseOutCubic &, Float4 t ) { return easeOutCubic4( t ); } };
+template<> struct BatchKernel<EaseInOutCubic> : BatchKernelAvailable { static Float4 eval( const EaseInOutCubic &, Float4 t ) { return easeInOutCubic4( t ); } };
+template<> struct BatchKernel<EaseOutInCubic> : BatchKernelAvailable { static Float4 eval( const EaseOutInCubic &, Float4 t ) { return easeOutInCubic4( t ); } };
+
+template<> struct BatchKernel<EaseInQuart> : BatchKernelAvailable { static Float4 eval( const EaseInQuart &, Float4 t ) { return easeInQuart4( t ); } };
+template<> struct BatchKernel<EaseOutQuart> : BatchKernelAvailable { static Float4 eval( const EaseOutQuart &, Float4 t ) { return easeOutQuart4( t ); } };
+template<> struct BatchKernel<EaseInOutQuart> : BatchKernelAvailable { static Float4 eval( const EaseInOutQuart &, Float4 t ) { return easeInOutQuart4( t ); } };
+template<> struct BatchKernel<EaseOutInQuart> : BatchKernelAvailable { static Float4 eval( const EaseOutInQuart &, Float4 t ) { return easeOutInQuart4( t ); } };
+
+template<> struct BatchKernel<EaseInQuint> : BatchKernelAvailable { static Float4 eval( const EaseInQuint &, Float4 t ) { return easeInQuint4( t ); } };
+template<> struct BatchKernel<EaseOutQuint> : BatchKernelAvailable { static Float4 eval( const EaseOutQuint &, Float4 t ) { return easeOutQuint4( t ); } };
+template<> struct BatchKernel<EaseInOutQuint> : BatchKernelAvailable { static Float4 eval( const EaseInOutQuint &, Float4 t ) { return easeInOutQuint4( t ); } };
+template<> struct BatchKernel<EaseOutInQuint> : BatchKernelAvailable { static Float4 eval( const EaseOutInQuint &, Float4 t ) { return easeOutInQuint4( t ); } };
+
+template<> struct BatchKernel<EaseInSine> : BatchKernelAvailable { static Float4 eval( const EaseInSine &, Float4 t ) { return easeInSine4( t ); } };
+template<> struct BatchKernel<EaseOutSine> : BatchKernelAvailable { static Float4 eval( const EaseOutSine &, Float4 t ) { return easeOutSine4( t ); } };
+template<> struct BatchKernel<EaseInOutSine> : BatchKernelAvailable { static Float4 eval( const EaseInOutSine &, Float4 t ) { return easeInOutSine4( t ); } };
+template<> struct BatchKernel<EaseOutInSine> : BatchKernelAvailable { static Float4 eval( const EaseOutInSine &, Float4 t ) { return easeOutInSine4( t ); } };
+
+template<> struct BatchKernel<EaseInExpo> : BatchKernelAvailable { static Float4 eval( const EaseInExpo &, Float4 t ) { return easeInExpo4( t ); } };
+template<> struct BatchKernel<EaseOutExpo> : BatchKernelAvailable { static Float4 eval( const EaseOutExpo &, Float4 t ) { return easeOutExpo4( t ); } };
+template<> struct BatchKernel<EaseInOutExpo> : BatchKernelAvailable { static Float4 eval( const EaseInOutExpo &, Float4 t ) { return easeInOutExpo4( t ); } };
+template<> struct BatchKernel<EaseOutInExpo> : BatchKernelAvailable { static Float4 eval( const EaseOutInExpo &, Float4 t ) { return easeOutInExpo4( t ); } };
+
+template<> struct BatchKernel<EaseInCirc> : BatchKernelAvailable { static Float4 eval( const EaseInCirc &, Float4 t ) { return easeInCirc4( t ); } };
+template<> struct BatchKernel<EaseOutCirc> : BatchKernelAvailable { static Float4 eval( const EaseOutCirc &, Float4 t ) { return easeOutCirc4( t ); } };
+template<> struct BatchKernel<EaseInOutCirc> : BatchKernelAvailable { static Float4 eval( const EaseInOutCirc &, Float4 t ) { return easeInOutCirc4( t ); } };
+template<> struct BatchKernel<EaseOutInCirc> : BatchKernelAvailable { static Float4 eval( const EaseOutInCirc &, Float4 t ) { return easeOutInCirc4( t ); } };
+
+template<> struct BatchKernel<EaseInBack> : BatchKernelAvailable { static Float4 eval( const EaseInBack &e, Float4 t ) { return easeInBack4( t, e.mS ); } };
+template<> struct BatchKernel<EaseOutBack> : BatchKernelAvailable { static Float4 eval( const EaseOutBack &e, Float4 t ) { return easeOutBack4( t, e.mS ); } };
+template<> struct BatchKernel<EaseInOutBack> : BatchKernelAvailable { static Float4 eval( const EaseInOutBack &e, Float4 t ) { return easeInOutBack4( t, e.mS ); } };
+template<> struct BatchKernel<EaseOutInBack> : BatchKernelAvailable { static Float4 eval( const EaseOutInBack &e, Float4 t ) { return easeOutInBack4( t, e.mS ); } };
+
+template<> struct BatchKernel<EaseInBounce> : BatchKernelAvailable { static Float4 eval( const EaseInBounce &e, Float4 t ) { return easeInBounce4( t, e.mA ); } };
+template<> struct BatchKernel<EaseOutBounce> : BatchKernelAvailable { static Float4 eval( const EaseOutBounce &e, Float4 t ) { return easeOutBounce4( t, e.mA ); } };
+template<> struct BatchKernel<EaseInOutBounce> : BatchKernelAvailable { static Float4 eval( const EaseInOutBounce &e, Float4 t ) { return easeInOutBounce4( t, e.mA ); } };
+template<> struct BatchKernel<EaseOutInBounce> : BatchKernelAvailable { static Float4 eval( const EaseOutInBounce &e, Float4 t ) { return easeOutInBounce4( t, e.mA ); } };
+
+template<> struct BatchKernel<EaseInElastic> : BatchKernelAvailable { static Float4 eval( const EaseInElastic &e, Float4 t ) { return easeInElastic4( t, e.mA, e.mP ); } };
+template<> struct BatchKernel<EaseOutElastic> : BatchKernelAvailable { static Float4 eval( const EaseOutElastic &e, Float4 t ) { return easeOutElastic4( t, e.mA, e.mP ); } };
+template<> struct BatchKernel<EaseInOutElastic> : BatchKernelAvailable { static Float4 eval( const EaseInOutElastic &e, Float4 t ) { return easeInOutElastic4( t, e.mA, e.mP ); } };
+template<> struct BatchKernel<EaseOutInElastic> : BatchKernelAvailable { static Float4 eval( const EaseOutInElastic &e, Float4 t ) { return easeOutInElastic4( t, e.mA, e.mP ); } };
+
+template<> struct BatchKernel<EaseInAtan> : BatchKernelAvailable { static Float4 eval( const EaseInAtan &e, Float4 t ) { return ( atanApprox( (t - 1.0f) * e.mA ) * e.mInvM ) + 1.0f; } };
+template<> struct BatchKernel<EaseOutAtan> : BatchKernelAvailable { static Float4 eval( const EaseOutAtan &e, Float4 t ) { return atanApprox( t * e.mA ) * e.mInvM; } };
+template<> struct BatchKernel<EaseInOutAtan> : BatchKernelAvailable { static Float4 eval( const EaseInOutAtan &e, Float4 t ) { return ( atanApprox( (t - 0.5f) * e.mA ) * e.mInv2M ) + 0.5f; } };
+
+template<typename EaseT>
+void easeBatch( const EaseT &ease, const float *t, float *out, size_t count, std::true_type )
+{
+  size_t i = 0;
+  for( ; i + 4 <= count; i += 4 ) {
+    store4( out + i, BatchKernel<EaseT>::eval( ease, load4( t + i ) ) );
+  }
+
+  if( i < count ) {
+    // Run the remainder through the same kernel so every element gets the same precision.
+    float tail[4] = { 0, 0, 0, 0 };
+    for( size_t j = i; j < count; j += 1 ) {
+      tail[j - i] = t[j];
+    }
+    store4( tail, BatchKernel<EaseT>::eval( ease, load4( tail ) ) );
+    for( size_t j = i; j < count; j += 1 ) {
+      out[j] = tail[j - i];
+    }
+  }
+}
+
+template<typename EaseT>
+void easeBatch( const EaseT &ease, const float *t, float *out, size_t count, std::false_type )
+{
+  // Some functors have non-const call operators.
+  auto fn = ease;
+  for( size_t i = 0; i < count; i += 1 ) {
+    out[i] = fn( t[i] );
+  }
+}
+
+} // namespace detail
+
+/// Returns true if \a EaseT has a batch kernel. Other ease functions are called once per time by easeBatch().
+template<typename EaseT>
+constexpr bool hasBatchKernel() { return detail::BatchKernel<typename std::decay<EaseT>::type>::available; }
+
+/// Evaluates \a ease at each of the \a count normalized times in \a t, writing results to \a out.
+/// \a t and \a out may be the same array.
+template<typename EaseT>
+void easeBatch( const EaseT &ease, const float *t, float *out, size_t count )
+{
+  detail::easeBatch( ease, t, out, count, std::integral_constant<bool, hasBatchKernel<EaseT>()>() );
+}
+
+} // namespace choreograph
@@ -29,6 +29,9 @@
 
 // Timeline.h includes most of Choreograph.
 #include "Timeline.h"
+#include "OutputBuffer.hpp"
+#include "LargeSequence.hpp"
+#include "CompactSequence.hpp"
 
 #include "phrase/Ramp.hpp"
 #include "phrase/Hold.hpp"
@@ -36,6 +39,7 @@
 #include "phrase/Combine.hpp"
 #include "phrase/Procedural.hpp"
 #include "phrase/Sugar.hpp"
+#include "BatchEasing.h"
 
 #if defined( CINDER_CINDER )
   #include "specialization/CinderSpecialization.hpp"
@@ -0,0 +1,412 @@
+/*
+ * Copyright (c) 2014 David Wicks, sansumbrella.com
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include "Sequence.hpp"
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+namespace choreograph
+{
+namespace detail
+{
+
+///
+/// Holds one Phrase by value, constructed in place when it fits in \a Capacity bytes, is copyable, and moves without throwing.
+/// Other Phrases are held through a PhraseRef instead, so any Phrase<T> can be stored.
+/// Moving an InlinePhrase moves the Phrase, so growing a vector of them doesn't copy any std::function members.
+///
+template<typename T, size_t Capacity>
+class InlinePhrase
+{
+public:
+  /// Returns true if PhraseT is stored in place rather than through a pointer.
+  template<typename PhraseT>
+  static constexpr bool fits() { return sizeof( PhraseT ) <= Capacity && alignof( PhraseT ) <= alignof( std::max_align_t ) && std::is_copy_constructible<PhraseT>::value && std::is_nothrow_move_constructible<PhraseT>::value; }
+
+  /// Constructs a PhraseT from \a args, in place if it fits.
+  template<typename PhraseT, typename... Args>
+  static InlinePhrase create( Args&&... args )
+  {
+    InlinePhrase phrase;
+    phrase.template emplace<PhraseT>( std::integral_constant<bool, fits<PhraseT>()>(), std::forward<Args>( args )... );
+    return phrase;
+  }
+
+  /// Holds \a phrase by pointer.
+  explicit InlinePhrase( const PhraseRef<T> &phrase ) { emplaceHeld<PhraseRef<T>>( phrase ); }
+
+  InlinePhrase( const InlinePhrase &other ) { copyFrom( other ); }
+  InlinePhrase& operator= ( const InlinePhrase &rhs )
+  {
+    if( this != &rhs ) {
+      reset();
+      copyFrom( rhs );
+    }
+    return *this;
+  }
+  /// Moves the Phrase out of \a other, leaving \a other empty.
+  InlinePhrase( InlinePhrase &&other ) noexcept { moveFrom( other ); }
+  InlinePhrase& operator= ( InlinePhrase &&rhs ) noexcept
+  {
+    if( this != &rhs ) {
+      reset();
+      moveFrom( rhs );
+    }
+    return *this;
+  }
+  ~InlinePhrase() { reset(); }
+
+  const Phrase<T>&  get() const { return *_ops->get( const_cast<unsigned char*>( _storage ) ); }
+  const Phrase<T>*  operator-> () const { return &get(); }
+
+  /// Returns true if the Phrase is stored in place.
+  bool              isInline() const { return ! _ops->shared; }
+
+private:
+  /// Type-specific operations on the stored object.
+  struct Ops
+  {
+    Phrase<T>*  (*get)( void *storage );
+    void        (*copy)( void *destination, const void *source );
+    void        (*move)( void *destination, void *source );
+    void        (*destroy)( void *storage );
+    bool        shared;
+  };
+
+  alignas( std::max_align_t ) unsigned char _storage[Capacity < sizeof( PhraseRef<T> ) ? sizeof( PhraseRef<T> ) : Capacity];
+  const Ops     *_ops = nullptr;
+
+  InlinePhrase() = default;
+
+  static Phrase<T>* phraseOf( Phrase<T> *phrase ) { return phrase; }
+  static Phrase<T>* phraseOf( PhraseRef<T> *phrase ) { return phrase->get(); }
+
+  template<typename HeldT>
+  static const Ops* opsFor()
+  {
+    static const Ops ops = {
+      [] ( void *storage ) { return phraseOf( static_cast<HeldT*>( storage ) ); },
+      [] ( void *destination, const void *source ) { ::new( destination ) HeldT( *static_cast<const HeldT*>( source ) ); },
+      [] ( void *destination, void *source ) { ::new( destination ) HeldT( std::move( *static_cast<HeldT*>( source ) ) ); },
+      [] ( void *storage ) { static_cast<HeldT*>( storage )->~HeldT(); },
+      std::is_same<HeldT, PhraseRef<T>>::value
+    };
+    return &ops;
+  }
+
+  template<typename HeldT, typename... Args>
+  void emplaceHeld( Args&&... args )
+  {
+    ::new( _storage ) HeldT( std::forward<Args>( args )... );
+    _ops = opsFor<HeldT>();
+  }
+
+  template<typename PhraseT, typename... Args>
+  void emplace( std::true_type, Args&&... args ) { emplaceHeld<PhraseT>( std::forward<Args>( args )... ); }
+
+  template<typename PhraseT, typename... Args>
+  void emplace( std::false_type, Args&&... args ) { emplaceHeld<PhraseRef<T>>( detail::make_pooled<PhraseT>( std::forward<Args>( args )... ) ); }
+
+  void copyFrom( const InlinePhrase &other )
+  {
+    if( other._ops ) {
+      other._ops->copy( _storage, other._storage );
+      _ops = other._ops;
+    }
+  }
+
+  void moveFrom( InlinePhrase &other ) noexcept
+  {
+    if( other._ops ) {
+      other._ops->move( _storage, other._storage );
+      _ops = other._ops;
+      other.reset();
+    }
+  }
+
+  void reset()
+  {
+    if( _ops ) {
+      _ops->destroy( _storage );
+      _ops = nullptr;
+    }
+  }
+};
+
+} // namespace detail
+
+template<typename T, size_t Capacity>
+class CompactSequencePhrase;
+
+///
+/// A Sequence that stores its Phrases by value, side by side in one array.
+/// Phrases up to \a Capacity bytes, which by default covers RampTo, StaticRampTo, Hold, and ClipPhrase,
+/// live in place; larger Phrases, like RampToN, and Phrases appended by PhraseRef are held by pointer.
+/// Copying a CompactSequence copies its Phrases rather than sharing them, so edits never affect other copies.
+/// Play a CompactSequence on a Timeline by wrapping it with asPhrase(). Copies of the resulting Sequence share one Phrase.
+/// Timeline::apply() still copies the Sequence it is given, PhraseRefs and all, so wrap long Sequences with asPhrase()
+/// (or share them, see Motion::SharedSequenceRef) to avoid that reference counting.
+///
+template<typename T, size_t Capacity = sizeof( RampTo<T> )>
+class CompactSequence
+{
+public:
+  using PhraseSlot = detail::InlinePhrase<T, Capacity>;
+
+  CompactSequence() = delete;
+
+  /// Construct a CompactSequence with an initial \a value.
+  explicit CompactSequence( const T &value ):
+    _initial_value( value )
+  {}
+
+  //
+  // Sequence manipulation and expansion.
+  //
+
+  /// Set the end \a value. See Sequence::set().
+  CompactSequence& set( const T &value );
+
+  /// Append a Phrase that starts with the current end value and ends with \a value after \a duration.
+  /// Forwards additional arguments to the end of the Phrase constructor. See Sequence::then().
+  template<template <typename> class PhraseT, typename... Args>
+  CompactSequence& then( const T &value, Time duration, Args&&... args ) { return append( PhraseSlot::template create<PhraseT<T>>( duration, getEndValue(), value, std::forward<Args>( args )... ) ); }
+
+  /// Append a ramp to \a value over \a duration. See Sequence::rampTo().
+  template<typename EaseT = EaseNone, typename LerpT = Lerp<T>>
+  CompactSequence& rampTo( const T &value, Time duration, EaseT ease_fn = EaseT(), LerpT lerp_fn = LerpT() ) { return append( PhraseSlot::template create<StaticRampTo<T, EaseT, LerpT>>( duration, getEndValue(), value, ease_fn, lerp_fn ) ); }
+
+  /// Append an existing phrase, held by pointer.
+  CompactSequence& then( const PhraseRef<T> &phrase ) { return append( PhraseSlot( phrase ) ); }
+
+  /// Append all Phrases from \a sequence, held by pointer.
+  CompactSequence& then( const Sequence<T> &sequence );
+
+  /// Reserve room for \a phrase_count Phrases.
+  void reserve( size_t phrase_count ) { _phrases.reserve( phrase_count ); _end_times.reserve( phrase_count ); }
+
+  //
+  // Phrase<T> Equivalents.
+  //
+
+  /// Returns the value at \a atTime.
+  T getValue( Time atTime ) const { SequenceCursor cursor; return getValue( atTime, cursor ); }
+
+  /// Returns the value at \a atTime, searching for the Phrase from \a cursor. See Sequence::getValue().
+  T getValue( Time atTime, SequenceCursor &cursor ) const;
+
+  /// Finds the span of time around \a atTime over which the value doesn't change. See Sequence::getConstantSpan().
+  bool getConstantSpan( Time atTime, SequenceCursor &cursor, Time *begin, Time *end ) const;
+
+  /// Writes the value at each of the \a count \a times to \a out. See Sequence::getValues().
+  void getValues( const Time *times, T *out, size_t count ) const;
+
+  T getStartValue() const { return _phrases.empty() ? _initial_value : _phrases.front()->getStartValue(); }
+  T getEndValue() const { return _phrases.empty() ? _initial_value : _phrases.back()->getEndValue(); }
+  Time getDuration() const { return _end_times.empty() ? 0 : _end_times.back(); }
+
+  /// Returns true if every Phrase is thread safe. See Sequence::isThreadSafe().
+  bool isThreadSafe() const { return _unsafe_phrases == 0; }
+
+  /// Returns the Phrase at \a index.
+  const Phrase<T>&  getPhraseAtIndex( size_t index ) const { return _phrases.at( index ).get(); }
+  /// Returns true if the Phrase at \a index is stored in place rather than by pointer.
+  bool              isPhraseInline( size_t index ) const { return _phrases.at( index ).isInline(); }
+
+  size_t getPhraseCount() const { return _phrases.size(); }
+  size_t size() const { return _phrases.size(); }
+  bool   empty() const { return _phrases.empty(); }
+
+  //
+  // Conversion.
+  //
+
+  /// Returns a Phrase that encapsulates a copy of this Sequence.
+  PhraseRef<T> asPhrase() const { return detail::make_pooled<CompactSequencePhrase<T, Capacity>>( *this ); }
+
+private:
+  std::vector<PhraseSlot> _phrases;
+  // Time at which each Phrase ends.
+  std::vector<Time>       _end_times;
+  T                       _initial_value;
+  // Number of Phrases that aren't thread safe.
+  size_t                  _unsafe_phrases = 0;
+
+  CompactSequence& append( PhraseSlot &&phrase );
+  Time getPhraseStartTime( size_t index ) const { return index == 0 ? 0 : _end_times[index - 1]; }
+};
+
+/// A Phrase that wraps up a CompactSequence, so it can play in a Sequence.
+template<typename T, size_t Capacity>
+class CompactSequencePhrase : public Phrase<T>
+{
+public:
+  explicit CompactSequencePhrase( const CompactSequence<T, Capacity> &sequence ):
+    Phrase<T>( sequence.getDuration() ),
+    _sequence( sequence )
+  {}
+
+  T getValue( Time atTime ) const override { return _sequence.getValue( atTime ); }
+
+  void getValues( const Time *times, T *out, size_t count ) const override { _sequence.getValues( times, out, count ); }
+
+  bool getConstantSpan( Time at_time, Time *begin, Time *end ) const override
+  {
+    SequenceCursor cursor;
+    return _sequence.getConstantSpan( at_time, cursor, begin, end );
+  }
+
+  T getStartValue() const override { return _sequence.getStartValue(); }
+  T getEndValue() const override { return _sequence.getEndValue(); }
+
+  bool isThreadSafe() const override { return _sequence.isThreadSafe(); }
+
+private:
+  CompactSequence<T, Capacity> _sequence;
+};
+
+//=================================================
+// CompactSequence Template Implementation.
+//=================================================
+
+template<typename T, size_t Capacity>
+CompactSequence<T, Capacity>& CompactSequence<T, Capacity>::set( const T &value )
+{
+  if( _phrases.empty() ) {
+    _initial_value = value;
+  }
+  else {
+    then<Hold>( value, 0.0f );
+  }
+  return *this;
+}
+
+template<typename T, size_t Capacity>
+CompactSequence<T, Capacity>& CompactSequence<T, Capacity>::then( const Sequence<T> &sequence )
+{
+  reserve( size() + sequence.size() );
+  for( size_t i = 0; i < sequence.size(); i += 1 ) {
+    then( sequence.getPhraseAtIndex( i ) );
+  }
+  return *this;
+}
+
+template<typename T, size_t Capacity>
+CompactSequence<T, Capacity>& CompactSequence<T, Capacity>::append( PhraseSlot &&phrase )
+{
+  _end_times.push_back( getDuration() + phrase->getDuration() );
+  _unsafe_phrases += phrase->isThreadSafe() ? 0 : 1;
+  _phrases.push_back( std::move( phrase ) );
+  return *this;
+}
+
+template<typename T, size_t Capacity>
+T CompactSequence<T, Capacity>::getValue( Time atTime, SequenceCursor &cursor ) const
+{
+  if( atTime < 0 )
+  {
+    return _initial_value;
+  }
+  else if( atTime >= getDuration() )
+  {
+    return getEndValue();
+  }
+
+  auto index = detail::seekPhrase( _end_times.data(), _end_times.size(), atTime, cursor );
+  return _phrases[index]->getValue( atTime - getPhraseStartTime( index ) );
+}
+
+template<typename T, size_t Capacity>
+bool CompactSequence<T, Capacity>::getConstantSpan( Time atTime, SequenceCursor &cursor, Time *begin, Time *end ) const
+{
+  const auto duration = getDuration();
+  if( atTime < 0 )
+  {
+    *begin = - std::numeric_limits<Time>::infinity();
+    *end = 0;
+    return true;
+  }
+  else if( atTime >= duration )
+  {
+    *begin = duration;
+    *end = std::numeric_limits<Time>::infinity();
+    return true;
+  }
+
+  const auto index = detail::seekPhrase( _end_times.data(), _end_times.size(), atTime, cursor );
+  const auto start = getPhraseStartTime( index );
+  if( ! _phrases[index]->getConstantSpan( atTime - start, begin, end ) ) {
+    return false;
+  }
+
+  // Times outside the Phrase belong to its neighbors.
+  *begin = std::max( start + *begin, start );
+  *end = std::min( start + *end, _end_times[index] );
+  return true;
+}
+
+template<typename T, size_t Capacity>
+void CompactSequence<T, Capacity>::getValues( const Time *times, T *out, size_t count ) const
+{
+  const auto duration = getDuration();
+  SequenceCursor cursor;
+  Time local_times[detail::SampleChunkSize];
+
+  size_t i = 0;
+  while( i < count )
+  {
+    const auto t = times[i];
+    if( t < 0 || t >= duration ) {
+      out[i] = (t < 0) ? _initial_value : getEndValue();
+      i += 1;
+      continue;
+    }
+
+    // Gather the following times that land in the same phrase.
+    const auto index = detail::seekPhrase( _end_times.data(), _end_times.size(), t, cursor );
+    const auto start = getPhraseStartTime( index );
+    const auto end = _end_times[index];
+    size_t n = 0;
+    while( n < detail::SampleChunkSize && i + n < count )
+    {
+      const auto u = times[i + n];
+      if( u < 0 || u >= duration || u > end || (u <= start && index != 0) ) {
+        break;
+      }
+      local_times[n] = u - start;
+      n += 1;
+    }
+
+    _phrases[index]->getValues( local_times, out + i, n );
+    i += n;
+  }
+}
+
+} // namespace choreograph
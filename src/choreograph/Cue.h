@@ -49,6 +49,9 @@ public:
   /// Cues are instantaneous.
   Time getDuration() const final override { return 0.0f; }
 
+  /// Cues only act when their time crosses zero.
+  bool idleUntilStart() const final override { return true; }
+
 private:
   std::function<void ()>    _cue;
 };
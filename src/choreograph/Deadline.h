@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 2014 David Wicks, sansumbrella.com
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+
+namespace choreograph
+{
+
+///
+/// A point in time by which a budgeted Timeline::step() should stop evaluating items.
+/// Measured on a steady clock, so it is unaffected by changes to the system time.
+///
+class Deadline
+{
+public:
+  using Clock = std::chrono::steady_clock;
+
+  explicit Deadline( Clock::time_point when ):
+    _when( when )
+  {}
+
+  /// Returns a Deadline \a seconds from now.
+  static Deadline fromNow( double seconds ) { return Deadline( Clock::now() + std::chrono::duration_cast<Clock::duration>( std::chrono::duration<double>( seconds ) ) ); }
+
+  /// Returns true once the deadline has passed.
+  bool    passed() const { return Clock::now() >= _when; }
+
+  /// Returns the seconds left until the deadline. Negative once it has passed.
+  double  remaining() const { return std::chrono::duration<double>( _when - Clock::now() ).count(); }
+
+  Clock::time_point when() const { return _when; }
+
+private:
+  Clock::time_point _when;
+};
+
+///
+/// Results of the most recent budgeted step. See Timeline::step( Time, const Deadline& ).
+///
+struct BudgetStats
+{
+  /// Items stepped.
+  size_t  updated = 0;
+  /// Items held back by their update interval.
+  size_t  skipped = 0;
+  /// Items held back until a later step because the deadline passed.
+  size_t  deferred = 0;
+  /// Seconds the step ran past its deadline. Zero if it finished in time.
+  double  overrun = 0;
+  /// Number of budgeted steps that ran past their deadline since the Timeline was created.
+  size_t  overrun_steps = 0;
+};
+
+namespace detail
+{
+
+///
+/// Checks a Deadline every few calls, since reading the clock costs about as much as stepping a Motion.
+/// Stays passed once the deadline has passed.
+///
+class DeadlineCheck
+{
+public:
+  explicit DeadlineCheck( const Deadline &deadline ):
+    _deadline( deadline )
+  {}
+
+  bool passed()
+  {
+    if( ! _passed && (_calls & 15) == 0 ) {
+      _passed = _deadline.passed();
+    }
+    _calls += 1;
+    return _passed;
+  }
+
+private:
+  const Deadline  &_deadline;
+  size_t          _calls = 0;
+  bool            _passed = false;
+};
+
+} // namespace detail
+} // namespace choreograph
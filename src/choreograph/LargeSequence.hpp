@@ -0,0 +1,493 @@
+/*
+ * Copyright (c) 2014 David Wicks, sansumbrella.com
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include "Sequence.hpp"
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+namespace choreograph
+{
+
+///
+/// A Sequence for very long, frequently edited lists of Phrases.
+/// Phrases are kept in a balanced tree (an implicit treap) where each node stores the total duration of its subtree,
+/// so inserting, removing, and replacing Phrases, and finding the Phrase at a time or index, are all O(log n).
+/// Sequence<T> is faster to play back and to append to. Use LargeSequence when edits in the middle dominate,
+/// and call toSequence() to play the result on a Timeline.
+///
+template<typename T>
+class LargeSequence
+{
+public:
+  LargeSequence() = delete;
+
+  /// Construct a LargeSequence with an initial \a value.
+  explicit LargeSequence( const T &value ):
+    _initial_value( value )
+  {}
+
+  /// Construct a LargeSequence holding the Phrases of \a sequence.
+  explicit LargeSequence( const Sequence<T> &sequence ):
+    _initial_value( sequence.getStartValue() )
+  {
+    then( sequence );
+  }
+
+  //
+  // Sequence manipulation and expansion.
+  //
+
+  /// Append a Phrase that starts with the current end value and ends with \a value after \a duration.
+  /// Forwards additional arguments to the end of the Phrase constructor. See Sequence::then().
+  template<template <typename> class PhraseT, typename... Args>
+  LargeSequence<T>& then( const T &value, Time duration, Args&&... args ) { return then( detail::make_pooled<PhraseT<T>>( duration, getEndValue(), value, std::forward<Args>( args )... ) ); }
+
+  /// Append an existing phrase.
+  LargeSequence<T>& then( const PhraseRef<T> &phrase ) { _root = merge( _root, createNode( phrase ) ); return *this; }
+
+  /// Append all Phrases from \a sequence.
+  LargeSequence<T>& then( const Sequence<T> &sequence );
+
+  /// Inserts \a phrases before the Phrase at \a index. An \a index of size() appends.
+  /// Throws std::out_of_range if \a index is past the end.
+  void insert( size_t index, const std::vector<PhraseRef<T>> &phrases );
+  void insert( size_t index, const PhraseRef<T> &phrase ) { insert( index, std::vector<PhraseRef<T>>( 1, phrase ) ); }
+
+  /// Removes up to \a phrase_count Phrases starting with the Phrase at \a index.
+  /// Throws std::out_of_range if \a index is past the end.
+  void erase( size_t index, size_t phrase_count = 1 );
+
+  /// Splices a collection of Phrases into the sequence at \a start_index. See Sequence::splice().
+  void splice( size_t start_index, size_t phrases_to_remove, const std::vector<PhraseRef<T>> &phrases_to_insert );
+
+  /// Replaces a single Phrase.
+  /// Throws std::out_of_range if the index provided is out of bounds.
+  void replacePhraseAtIndex( size_t index, const PhraseRef<T> &phrase ) { replace( _root, checkIndex( index ), phrase ); }
+
+  //
+  // Lookup.
+  //
+
+  /// Returns the phrase at the requested index.
+  /// Throws std::out_of_range if the index provided is out of bounds.
+  PhraseRef<T> getPhraseAtIndex( size_t index ) const { return _nodes[findNode( checkIndex( index ) )].phrase; }
+
+  /// Returns the index of the Phrase playing at \a time, using the same rules as Sequence.
+  /// Phrases own their end time. Times past the end belong to the last Phrase.
+  /// If there are no phrases, behavior is undefined (asserts in debug builds).
+  size_t getPhraseIndexAtTime( Time time ) const { size_t index; Time start; findNodeAtTime( time, &index, &start ); return index; }
+
+  /// Returns the phrase at the requested time. See getPhraseIndexAtTime().
+  PhraseRef<T> getPhraseAtTime( Time time ) const { size_t index; Time start; return _nodes[findNodeAtTime( time, &index, &start )].phrase; }
+
+  /// Returns the time at which the Phrase at \a index begins. An \a index of size() returns the duration.
+  Time getPhraseStartTime( size_t index ) const;
+
+  //
+  // Phrase<T> Equivalents.
+  //
+
+  /// Returns the value at \a atTime.
+  T getValue( Time atTime ) const;
+
+  /// Returns the value at the beginning of the Sequence.
+  T getStartValue() const { return empty() ? _initial_value : _nodes[edgeNode( true )].phrase->getStartValue(); }
+
+  /// Returns the value at the end of the Sequence.
+  T getEndValue() const { return empty() ? _initial_value : _nodes[edgeNode( false )].phrase->getEndValue(); }
+
+  /// Returns the total duration of all Phrases.
+  Time getDuration() const { return sum( _root ); }
+
+  size_t getPhraseCount() const { return count( _root ); }
+  size_t size() const { return count( _root ); }
+  bool   empty() const { return _root == NoNode; }
+
+  //
+  // Conversion.
+  //
+
+  /// Returns a Sequence holding the same Phrases. O(n).
+  Sequence<T> toSequence() const;
+
+  /// Returns a Phrase that encapsulates a copy of this Sequence.
+  PhraseRef<T> asPhrase() const { return toSequence().asPhrase(); }
+
+private:
+  static const uint32_t NoNode = 0xFFFFFFFF;
+
+  struct Node
+  {
+    PhraseRef<T>  phrase;
+    Time          duration = 0;
+    /// Total duration of the subtree rooted here.
+    Time          sum = 0;
+    /// Number of Phrases in the subtree rooted here.
+    uint32_t      count = 1;
+    uint32_t      priority = 0;
+    uint32_t      left = NoNode;
+    uint32_t      right = NoNode;
+  };
+
+  // Nodes refer to each other by index, so copying a LargeSequence copies the tree.
+  std::vector<Node>     _nodes;
+  // Indices of unused entries in _nodes.
+  std::vector<uint32_t> _free;
+  uint32_t              _root = NoNode;
+  // State of the generator for node priorities.
+  uint32_t              _seed = 0x9E3779B9;
+  T                     _initial_value;
+
+  Time      sum( uint32_t node ) const { return node == NoNode ? 0 : _nodes[node].sum; }
+  size_t    count( uint32_t node ) const { return node == NoNode ? 0 : _nodes[node].count; }
+  /// Returns \a index, or throws std::out_of_range if there is no Phrase at \a index.
+  size_t    checkIndex( size_t index ) const;
+
+  uint32_t  createNode( const PhraseRef<T> &phrase );
+  /// Returns the nodes of the subtree rooted at \a node to the free list.
+  void      freeTree( uint32_t node );
+  /// Recomputes the sum and count of \a node from its children.
+  void      refresh( uint32_t node );
+  /// Splits the tree rooted at \a node into its first \a index Phrases and the rest.
+  void      split( uint32_t node, size_t index, uint32_t *left, uint32_t *right );
+  /// Joins two trees, with all Phrases of \a left before those of \a right. Returns the new root.
+  uint32_t  merge( uint32_t left, uint32_t right );
+  /// Replaces the Phrase at \a index in the subtree rooted at \a node.
+  void      replace( uint32_t node, size_t index, const PhraseRef<T> &phrase );
+
+  /// Returns the node holding the Phrase at \a index.
+  uint32_t  findNode( size_t index ) const;
+  /// Returns the node holding the Phrase at \a time, along with its index and start time.
+  uint32_t  findNodeAtTime( Time time, size_t *index, Time *start ) const;
+  /// Returns the first or last node.
+  uint32_t  edgeNode( bool first ) const;
+};
+
+//=================================================
+// LargeSequence Template Implementation.
+//=================================================
+
+template<typename T>
+LargeSequence<T>& LargeSequence<T>::then( const Sequence<T> &sequence )
+{
+  std::vector<PhraseRef<T>> phrases;
+  phrases.reserve( sequence.size() );
+  for( size_t i = 0; i < sequence.size(); i += 1 ) {
+    phrases.push_back( sequence.getPhraseAtIndex( i ) );
+  }
+  insert( size(), phrases );
+
+  return *this;
+}
+
+template<typename T>
+void LargeSequence<T>::insert( size_t index, const std::vector<PhraseRef<T>> &phrases )
+{
+  if( index > size() ) {
+    throw std::out_of_range( "LargeSequence insertion index out of range." );
+  }
+
+  uint32_t inserted = NoNode;
+  for( auto &phrase : phrases ) {
+    inserted = merge( inserted, createNode( phrase ) );
+  }
+
+  uint32_t left, right;
+  split( _root, index, &left, &right );
+  _root = merge( merge( left, inserted ), right );
+}
+
+template<typename T>
+void LargeSequence<T>::erase( size_t index, size_t phrase_count )
+{
+  if( index > size() ) {
+    throw std::out_of_range( "LargeSequence erasure index out of range." );
+  }
+
+  uint32_t left, middle, right;
+  split( _root, index, &left, &right );
+  split( right, phrase_count, &middle, &right );
+  freeTree( middle );
+  _root = merge( left, right );
+}
+
+template<typename T>
+void LargeSequence<T>::splice( size_t start_index, size_t phrases_to_remove, const std::vector<PhraseRef<T>> &phrases_to_insert )
+{
+  erase( start_index, phrases_to_remove );
+  insert( start_index, phrases_to_insert );
+}
+
+template<typename T>
+Time LargeSequence<T>::getPhraseStartTime( size_t index ) const
+{
+  Time start = 0;
+  auto node = _root;
+  while( node != NoNode )
+  {
+    const auto &current = _nodes[node];
+    const auto left_count = count( current.left );
+    if( index <= left_count ) {
+      node = current.left;
+    }
+    else {
+      start += sum( current.left ) + current.duration;
+      index -= left_count + 1;
+      node = current.right;
+    }
+  }
+  return start;
+}
+
+template<typename T>
+T LargeSequence<T>::getValue( Time atTime ) const
+{
+  if( atTime < 0 )
+  {
+    return _initial_value;
+  }
+  else if( atTime >= getDuration() )
+  {
+    return getEndValue();
+  }
+
+  size_t index;
+  Time start;
+  const auto node = findNodeAtTime( atTime, &index, &start );
+  return _nodes[node].phrase->getValue( atTime - start );
+}
+
+template<typename T>
+Sequence<T> LargeSequence<T>::toSequence() const
+{
+  Sequence<T> sequence( _initial_value );
+
+  // In-order traversal without recursion, since the tree can be deep in unlucky cases.
+  std::vector<uint32_t> stack;
+  auto node = _root;
+  while( node != NoNode || ! stack.empty() )
+  {
+    while( node != NoNode ) {
+      stack.push_back( node );
+      node = _nodes[node].left;
+    }
+    node = stack.back();
+    stack.pop_back();
+    sequence.then( _nodes[node].phrase );
+    node = _nodes[node].right;
+  }
+
+  return sequence;
+}
+
+template<typename T>
+size_t LargeSequence<T>::checkIndex( size_t index ) const
+{
+  if( index >= size() ) {
+    throw std::out_of_range( "LargeSequence phrase index out of range." );
+  }
+  return index;
+}
+
+template<typename T>
+uint32_t LargeSequence<T>::createNode( const PhraseRef<T> &phrase )
+{
+  uint32_t index;
+  if( _free.empty() ) {
+    index = static_cast<uint32_t>( _nodes.size() );
+    _nodes.emplace_back();
+  }
+  else {
+    index = _free.back();
+    _free.pop_back();
+    _nodes[index] = Node();
+  }
+
+  // xorshift32
+  _seed ^= _seed << 13;
+  _seed ^= _seed >> 17;
+  _seed ^= _seed << 5;
+
+  auto &node = _nodes[index];
+  node.phrase = phrase;
+  node.duration = phrase->getDuration();
+  node.sum = node.duration;
+  node.priority = _seed;
+  return index;
+}
+
+template<typename T>
+void LargeSequence<T>::freeTree( uint32_t node )
+{
+  if( node == NoNode ) {
+    return;
+  }
+  freeTree( _nodes[node].left );
+  freeTree( _nodes[node].right );
+  _nodes[node].phrase.reset();
+  _free.push_back( node );
+}
+
+template<typename T>
+void LargeSequence<T>::refresh( uint32_t node )
+{
+  auto &current = _nodes[node];
+  current.sum = sum( current.left ) + current.duration + sum( current.right );
+  current.count = static_cast<uint32_t>( count( current.left ) + 1 + count( current.right ) );
+}
+
+template<typename T>
+void LargeSequence<T>::split( uint32_t node, size_t index, uint32_t *left, uint32_t *right )
+{
+  if( node == NoNode ) {
+    *left = *right = NoNode;
+    return;
+  }
+
+  const auto left_count = count( _nodes[node].left );
+  if( index <= left_count ) {
+    split( _nodes[node].left, index, left, &_nodes[node].left );
+    *right = node;
+  }
+  else {
+    split( _nodes[node].right, index - left_count - 1, &_nodes[node].right, right );
+    *left = node;
+  }
+  refresh( node );
+}
+
+template<typename T>
+uint32_t LargeSequence<T>::merge( uint32_t left, uint32_t right )
+{
+  if( left == NoNode ) {
+    return right;
+  }
+  if( right == NoNode ) {
+    return left;
+  }
+
+  if( _nodes[left].priority > _nodes[right].priority ) {
+    auto merged = merge( _nodes[left].right, right );
+    _nodes[left].right = merged;
+    refresh( left );
+    return left;
+  }
+  else {
+    auto merged = merge( left, _nodes[right].left );
+    _nodes[right].left = merged;
+    refresh( right );
+    return right;
+  }
+}
+
+template<typename T>
+void LargeSequence<T>::replace( uint32_t node, size_t index, const PhraseRef<T> &phrase )
+{
+  auto &current = _nodes[node];
+  const auto left_count = count( current.left );
+  if( index < left_count ) {
+    replace( current.left, index, phrase );
+  }
+  else if( index > left_count ) {
+    replace( current.right, index - left_count - 1, phrase );
+  }
+  else {
+    current.phrase = phrase;
+    current.duration = phrase->getDuration();
+  }
+  refresh( node );
+}
+
+template<typename T>
+uint32_t LargeSequence<T>::findNode( size_t index ) const
+{
+  auto node = _root;
+  while( true )
+  {
+    const auto &current = _nodes[node];
+    const auto left_count = count( current.left );
+    if( index < left_count ) {
+      node = current.left;
+    }
+    else if( index == left_count ) {
+      return node;
+    }
+    else {
+      index -= left_count + 1;
+      node = current.right;
+    }
+  }
+}
+
+template<typename T>
+uint32_t LargeSequence<T>::findNodeAtTime( Time time, size_t *index, Time *start ) const
+{
+  assert( _root != NoNode );
+
+  // Looks for the first Phrase ending at or after time, like Sequence's binary search over end times.
+  size_t before = 0;
+  Time offset = 0;
+  auto node = _root;
+  while( true )
+  {
+    const auto &current = _nodes[node];
+    const auto left_end = offset + sum( current.left );
+    if( current.left != NoNode && time <= left_end ) {
+      node = current.left;
+      continue;
+    }
+
+    if( time <= left_end + current.duration || current.right == NoNode ) {
+      *index = before + count( current.left );
+      *start = left_end;
+      return node;
+    }
+
+    before += count( current.left ) + 1;
+    offset = left_end + current.duration;
+    node = current.right;
+  }
+}
+
+template<typename T>
+uint32_t LargeSequence<T>::edgeNode( bool first ) const
+{
+  auto node = _root;
+  while( true )
+  {
+    const auto next = first ? _nodes[node].left : _nodes[node].right;
+    if( next == NoNode ) {
+      return node;
+    }
+    node = next;
+  }
+}
+
+} // namespace choreograph
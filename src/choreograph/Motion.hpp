@@ -31,10 +31,13 @@
 #include "Sequence.hpp"
 #include "Output.hpp"
 #include "detail/VectorManipulation.hpp"
+#include "detail/PointerMap.hpp"
 
 namespace choreograph
 {
 
+template<typename T> class OutputPool;
+
 //=================================================
 // Aliases.
 //=================================================
@@ -52,6 +55,8 @@ class Motion : public TimelineItem
 public:
   using MotionT       = Motion<T>;
   using SequenceT     = Sequence<T>;
+  /// An immutable Sequence that many Motions can play without copying.
+  using SharedSequenceRef = std::shared_ptr<const SequenceT>;
   using Callback      = std::function<void ()>;
 
   Motion() = delete;
@@ -59,24 +64,48 @@ public:
   Motion( T *target, const SequenceT &sequence ):
     _target( target ),
     _source( sequence )
-  {}
+  {
+    setTypeKey( detail::typeKey<MotionT>() );
+  }
 
   Motion( Output<T> *target, const SequenceT &sequence ):
-    _target( target->valuePtr() ),
-    _output( target ),
-    _source( sequence )
+    Motion( target->slot(), sequence )
+  {}
+
+  Motion( Output<T> *target ):
+    Motion( target->slot(), SequenceT( target->value() ) )
+  {}
+
+  /// Plays \a sequence without copying it. The Motion copies it the first time its own Sequence is modified.
+  Motion( T *target, const SharedSequenceRef &sequence ):
+    Motion( target, SequenceT( sequence->getStartValue() ) )
   {
-    _output->disconnect();
-    _output->_input = this;
+    _shared_source = sequence;
   }
 
-  Motion( Output<T> *target ):
-    _target( target->valuePtr() ),
-    _output( target ),
-    _source( target->value() )
+  Motion( Output<T> *target, const SharedSequenceRef &sequence ):
+    Motion( target->slot(), sequence )
+  {}
+
+  Motion( const detail::OutputSlot<T> &target, const SharedSequenceRef &sequence ):
+    Motion( target, SequenceT( sequence->getStartValue() ) )
   {
-    _output->disconnect();
-    _output->_input = this;
+    _shared_source = sequence;
+  }
+
+  /// Connects to an Output or OutputPool element, disconnecting any Motion already connected to it.
+  Motion( const detail::OutputSlot<T> &target, const SequenceT &sequence ):
+    _source( sequence ),
+    _input_slot( target.input ),
+    _target( target.value ),
+    _changed_flag( target.changed ),
+    _stale_flag( target.stale )
+  {
+    setTypeKey( detail::typeKey<MotionT>() );
+    if( *_input_slot ) {
+      (*_input_slot)->disconnect();
+    }
+    *_input_slot = this;
   }
 
   ~Motion()
@@ -85,13 +114,19 @@ public:
   }
 
   /// Returns duration of the underlying sequence.
-  Time getDuration() const final override { return _source.getDuration(); }
+  Time getDuration() const final override { return source().getDuration(); }
 
   /// Returns ratio of time elapsed, from [0,1] over duration.
-  Time getProgress() const { return time() / _source.getDuration(); }
+  Time getProgress() const { return time() / source().getDuration(); }
 
   /// Returns the underlying Sequence sampled for this motion.
-  SequenceT&  getSequence() { return _source; }
+  /// Tells the parent Timeline the duration may change, so finish changes to the Sequence before the Timeline next steps.
+  /// Wakes the Motion if it was sleeping through a Hold. Copies a shared Sequence so changes don't affect other Motions.
+  SequenceT&  getSequence() { wakeIfParked(); durationChanged(); unshareSource(); return _source; }
+  /// Returns the underlying Sequence sampled for this motion.
+  const SequenceT&  getSequence() const { return source(); }
+  /// Returns true if the Motion is playing a Sequence shared with other Motions.
+  bool        isSequenceShared() const { return _shared_source != nullptr; }
 
   const void* getTarget() const final override { return _target; }
 
@@ -109,29 +144,84 @@ public:
 
   /// Set a function to be called at each update step of the sequence.
   /// Function will be called immediately after setting the target value.
-  void setUpdateFn( const Callback &c ) { _update_fn = c; }
+  void setUpdateFn( const Callback &c ) { wakeIfParked(); _update_fn = c; }
 
   /// Update the connected target with the current sequence value.
   /// Calls start/update/finish functions as appropriate if assigned.
   void update() final override;
 
+  /// Without an update function, a Motion waiting to start only rewrites the value it already wrote.
+  /// Checked after each step, so set the update function before the Motion is first stepped.
+  bool idleUntilStart() const final override { return ! _update_fn; }
+
+  /// Without an update function, a Motion is also idle while its Sequence value holds still, as in a Hold.
+  /// Values written to the target by anything else during that time aren't overwritten until the Motion wakes.
+  bool getIdleSpan( Time *begin, Time *end ) const final override;
+
+  /// Motions only write to their target when evaluated, so they can be evaluated in parallel if their Sequence is thread safe.
+  /// See Sequence::isThreadSafe().
+  bool supportsParallelEvaluation() const final override { return source().isThreadSafe(); }
+
+  /// Update the connected target with the current sequence value.
+  /// When evaluating lazily with an Output that can evaluate on read, marks the Output stale instead.
+  void evaluate() final override;
+
+  /// Calls start/inflection/update/finish functions as appropriate if assigned.
+  void dispatchCallbacks() final override { callStartFn(); reportChange(); callProgressFns(); }
+
+  /// Returns true if the last step changed the target's value.
+  /// Not updated while a MotionStorage::Bucketed Timeline evaluates the Motion from its bucket.
+  bool changedTarget() const { return _changed; }
+
   /// Removes phrases from sequence before specified time.
   /// Note that you can safely share sequences if you add them to each motion as phrases.
-  void cutPhrasesBefore( Time time ) { sliceSequence( time, _source.getDuration() ); }
+  void cutPhrasesBefore( Time time ) { sliceSequence( time, source().getDuration() ); }
   /// Cut animation in \a time from the Motion's current time().
   void cutIn( Time time ) { sliceSequence( this->time(), this->time() + time ); }
-  /// Slices up our underlying Sequence.
+  /// Slices up our underlying Sequence. Wakes the Motion if it was sleeping through a Hold.
   void sliceSequence( Time from, Time to );
 
 private:
   SequenceT       _source;
-  Output<T>       *_output = nullptr;
+  /// Sequence played instead of _source until the Motion modifies it. See SharedSequenceRef.
+  SharedSequenceRef _shared_source;
+  /// Phrase last evaluated in source(). Shared by evaluation and inflection detection.
+  SequenceCursor  _cursor;
+  /// Connected Output or OutputPool element's pointer to its writer. Points back at this Motion.
+  MotionT         **_input_slot = nullptr;
   T               *_target = nullptr;
+  /// Connected OutputPool element's change flag, if any.
+  uint8_t         *_changed_flag = nullptr;
+  /// True if the last evaluation changed the target's value.
+  bool            _changed = false;
+  /// Connected Output's stale flag, if it can evaluate on read.
+  bool            *_stale_flag = nullptr;
 
   Callback        _finish_fn;
   Callback        _start_fn;
   Callback        _update_fn;
-  std::vector<std::pair<int, Callback>>  _inflection_callbacks;
+  std::vector<std::pair<size_t, Callback>>  _inflection_callbacks;
+
+  /// Returns the Sequence this Motion plays.
+  const SequenceT& source() const { return _shared_source ? *_shared_source : _source; }
+  /// Copies a shared Sequence into _source before the Motion changes it.
+  void unshareSource()
+  {
+    if( _shared_source ) {
+      _source = *_shared_source;
+      _shared_source.reset();
+    }
+  }
+
+  /// Writes the current sequence value to the target and marks it fresh.
+  /// Skips the write when the value is unchanged, as during a Hold, and flags OutputPool elements that change.
+  void write();
+  /// Calls the start function if we just started.
+  void callStartFn();
+  /// Adds our target to the parent Timeline's change list if evaluation changed it.
+  void reportChange() { if( _changed ) { targetValueChanged( _target ); } }
+  /// Calls inflection, update, and finish functions as appropriate.
+  void callProgressFns();
 
   /// Sets the output to a different output.
   /// Used by Output<T>'s move assignment and move constructor.
@@ -142,6 +232,9 @@ private:
   /// Allow Outputs to call private methods.
   /// Could probably do a song and dance with lambdas to avoid friendship, but this is fine.
   friend class Output<T>;
+  friend class OutputPool<T>;
+  /// Allow buckets to evaluate Motions from their own copy of the Motion's state.
+  friend class detail::MotionBucket<T>;
 };
 
 //=================================================
@@ -150,6 +243,55 @@ private:
 
 template<typename T>
 void Motion<T>::update()
+{
+  callStartFn();
+  evaluate();
+  reportChange();
+  callProgressFns();
+}
+
+template<typename T>
+void Motion<T>::evaluate()
+{
+  if( _stale_flag && evaluatesLazily() ) {
+    *_stale_flag = true;
+    _changed = false;
+  }
+  else {
+    write();
+  }
+}
+
+template<typename T>
+void Motion<T>::write()
+{
+  _changed = detail::assignIfChanged( *_target, source().getValue( time(), _cursor ) );
+  if( _changed && _changed_flag ) {
+    *_changed_flag = 1;
+  }
+  if( _stale_flag ) {
+    *_stale_flag = false;
+  }
+}
+
+template<typename T>
+bool Motion<T>::getIdleSpan( Time *begin, Time *end ) const
+{
+  if( TimelineItem::getIdleSpan( begin, end ) ) {
+    return true;
+  }
+
+  // Start functions fire when leaving the start, so wait until we're past it.
+  if( _update_fn || (forward() ? time() <= 0.0f : time() >= getDuration()) ) {
+    return false;
+  }
+
+  auto cursor = _cursor;
+  return source().getConstantSpan( time(), cursor, begin, end );
+}
+
+template<typename T>
+void Motion<T>::callStartFn()
 {
   if( _start_fn )
   {
@@ -160,12 +302,15 @@ void Motion<T>::update()
       _start_fn();
     }
   }
+}
 
-  *_target = _source.getValue( time() );
-
+template<typename T>
+void Motion<T>::callProgressFns()
+{
   if( ! _inflection_callbacks.empty() )
   {
-    auto points = _source.getInflectionPoints( previousTime(), time() );
+    // Both lookups start near the phrase we just evaluated.
+    auto points = std::make_pair( source().seek( previousTime(), _cursor ), source().seek( time(), _cursor ) );
     if( points.first != points.second )
     {
       // We just crossed into the second inflection point
@@ -200,23 +345,28 @@ void Motion<T>::update()
 template<typename T>
 void Motion<T>::addInflectionCallback( size_t inflection_point, const Callback &callback )
 {
-  _inflection_callbacks.emplace_back( std::make_pair( (int)inflection_point, callback ) );
+  _inflection_callbacks.emplace_back( std::make_pair( inflection_point, callback ) );
 }
 
 template<typename T>
 void Motion<T>::sliceSequence( Time from, Time to )
 {
-  // Shift inflection point references
-  const auto inflection = _source.getInflectionPoints( from, to ).first;
+  wakeIfParked();
+
+  // Drop references to inflection points before the slice and shift the rest.
+  const auto inflection = source().getInflectionPoints( from, to ).first;
+  detail::erase_if( &_inflection_callbacks, [inflection] (const std::pair<size_t, Callback> &p) {
+    return p.first < inflection;
+  } );
+
   for( auto &fn : _inflection_callbacks ) {
     fn.first -= inflection;
   }
 
-  detail::erase_if( &_inflection_callbacks, [] (const std::pair<int, Callback> &p) {
-    return p.first < 0;
-  } );
-
-  _source = _source.slice( from, to );
+  _source = source().slice( from, to );
+  _shared_source.reset();
+  _cursor = SequenceCursor();
+  durationChanged();
 
   setTime( this->time() - from );
 }
@@ -224,22 +374,35 @@ void Motion<T>::sliceSequence( Time from, Time to )
 template<typename T>
 void Motion<T>::setOutput( Output<T> *output )
 {
-   if( _output ) {
-     _output->_input = nullptr;
-   }
+  // Buckets write to the target they were given.
+  wakeIfParked();
+  if( _input_slot ) {
+    *_input_slot = nullptr;
+  }
+  if( _stale_flag ) {
+    *_stale_flag = false;
+  }
 
-  _output = output;
-  _target = _output->valuePtr();
+  _input_slot = &output->_input;
+  _target = &output->_value;
+  _changed_flag = nullptr;
+  _stale_flag = &output->_stale;
+  targetChanged();
 }
 
 template<typename T>
 void Motion<T>::disconnect()
 {
   // Disconnect pointer.
-  if( _output ) {
-    _output->_input = nullptr;
-    _output = nullptr;
+  if( _input_slot ) {
+    // Leave a lazy Output with the value it would have had.
+    if( _stale_flag && *_stale_flag ) {
+      write();
+    }
+    *_input_slot = nullptr;
+    _input_slot = nullptr;
   }
+  _stale_flag = nullptr;
   // Stop evaluation of TimelineItem.
   cancel();
 }
@@ -27,11 +27,67 @@
 
 #pragma once
 
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
 namespace choreograph
 {
 
 template<typename T> class Motion;
 
+namespace detail
+{
+
+///
+/// Where a Motion writes its value, and where it records itself as the value's writer.
+/// Provided by Output and OutputPool, so Motions connect to and disconnect from both the same way.
+///
+template<typename T>
+struct OutputSlot
+{
+  T         *value;
+  Motion<T> **input;
+  /// Set to 1 when a Motion changes the value. Null if the output doesn't track changes.
+  uint8_t   *changed;
+  /// Set when a lazy Motion steps without writing the value. Null if the output can't evaluate on read.
+  bool      *stale;
+};
+
+/// True if T has an operator== returning something convertible to bool.
+template<typename T, typename = void>
+struct IsEqualityComparable : std::false_type {};
+
+template<typename T>
+struct IsEqualityComparable<T, typename std::enable_if<std::is_convertible<decltype( std::declval<const T&>() == std::declval<const T&>() ), bool>::value>::type> : std::true_type {};
+
+template<typename T>
+bool assignIfChanged( T &target, const T &value, std::true_type )
+{
+  if( target == value ) {
+    return false;
+  }
+  target = value;
+  return true;
+}
+
+template<typename T>
+bool assignIfChanged( T &target, const T &value, std::false_type )
+{
+  target = value;
+  return true;
+}
+
+/// Assigns \a value to \a target unless they compare equal. Returns true if \a target was assigned.
+/// Types without operator== are always assigned.
+template<typename T>
+bool assignIfChanged( T &target, const T &value )
+{
+  return assignIfChanged( target, value, IsEqualityComparable<T>() );
+}
+
+} // namespace detail
+
 ///
 /// Safe type for Choreograph outputs.
 /// Disconnects applied Motion on destruction so you don't accidentally modify stale pointers.
@@ -73,37 +129,44 @@ public:
   bool isConnected() const { return _input != nullptr; }
 
   /// Value assignment operator.
-  Output<T>& operator= ( T value ) { _value = value; return *this; }
+  Output<T>& operator= ( T value ) { _stale = false; _value = value; return *this; }
   /// Value add-assign.
-  Output<T>& operator+= ( T value ) { _value += value; return *this; }
+  Output<T>& operator+= ( T value ) { refresh(); _value += value; return *this; }
 
   /// Returns value of output.
-  const T&    value() const { return _value; }
+  /// If the connected Motion evaluates lazily, evaluates it first when it has stepped since the last read.
+  const T&    value() const { refresh(); return _value; }
 
   /// Returns value of output.
-  const T&    operator() () const { return _value; }
+  const T&    operator() () const { refresh(); return _value; }
 
   /// Returns value of output for manipulating.
-  T&          operator() () { return _value; }
+  T&          operator() () { refresh(); return _value; }
 
   /// Returns the value this output will have at the end of its connected motion.
   /// Returns current value if no motion attached.
   T           endValue() const;
 
   /// Enable cast to value type.
-  operator const T&()  { return _value; }
+  operator const T&()  { refresh(); return _value; }
 
   /// Returns pointer to value.
-  const T*    valuePtr() const { return &_value; }
+  const T*    valuePtr() const { refresh(); return &_value; }
 
   /// Returns pointer to value.
-  T*          valuePtr() { return &_value; }
+  T*          valuePtr() { refresh(); return &_value; }
 
   Motion<T>*  inputPtr() { return _input; }
 
 private:
   T         _value;
   Motion<T> *_input = nullptr;
+  /// True if a lazy input Motion stepped since _value was last written.
+  bool      _stale = false;
+
+  detail::OutputSlot<T> slot() { return detail::OutputSlot<T>{ &_value, &_input, nullptr, &_stale }; }
+  /// Has a lazy input Motion write the value if it stepped since the last write.
+  void refresh() const;
 
   friend class Motion<T>;
 };
@@ -116,7 +179,8 @@ private:
 template<typename T>
 Output<T>::Output( Output<T> &&rhs ):
   _value( std::move( rhs._value ) ),
-  _input( std::move( rhs._input ) )
+  _input( std::move( rhs._input ) ),
+  _stale( rhs._stale )
 {
   if( _input ) {
     _input->setOutput( this );
@@ -129,6 +193,7 @@ Output<T>& Output<T>::operator= ( Output<T> &&rhs ) {
   if( this != &rhs ) {
     _value = std::move( rhs._value );
     _input = std::move( rhs._input );
+    _stale = rhs._stale;
     if( _input ) {
       _input->setOutput( this );
     }
@@ -146,11 +211,20 @@ void Output<T>::disconnect()
   }
 }
 
+template<typename T>
+void Output<T>::refresh() const
+{
+  if( _stale ) {
+    // Clears _stale.
+    _input->write();
+  }
+}
+
 template<typename T>
 T Output<T>::endValue() const
 {
   if( _input ) {
-    return _input->getSequence().getEndValue();
+    return static_cast<const Motion<T>*>( _input )->getSequence().getEndValue();
   }
   return _value;
 }
@@ -0,0 +1,149 @@
+/*
+ * Copyright (c) 2014 David Wicks, sansumbrella.com
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include "Output.hpp"
+#include <atomic>
+#include <vector>
+
+namespace choreograph
+{
+
+class Timeline;
+
+///
+/// Non-templated interface to an OutputBuffer, so a Timeline can publish buffers of any value type.
+///
+class OutputBufferBase
+{
+public:
+  OutputBufferBase() = default;
+  OutputBufferBase( const OutputBufferBase &rhs ) = delete;
+  OutputBufferBase& operator= ( const OutputBufferBase &rhs ) = delete;
+  /// Detaches from its Timeline, if attached.
+  virtual ~OutputBufferBase();
+
+  /// Copies the current values into a snapshot and makes it the latest one for readers.
+  virtual void publish() = 0;
+
+private:
+  /// Timeline that publishes this buffer, if any.
+  Timeline  *_timeline = nullptr;
+  friend class Timeline;
+};
+
+///
+/// A fixed number of Outputs whose values are published as snapshots for another thread to read.
+/// Motions write to the Outputs on the updating thread as usual. After stepping, publish()
+/// (or Timeline::publish() for every attached buffer) copies the values into a back snapshot
+/// and swaps it in with one atomic exchange. The reading thread calls read() to get the
+/// latest complete snapshot, so it never sees values from two different steps within one buffer.
+/// Separate buffers are published independently and may be read from different steps.
+///
+/// Uses three snapshots, so neither thread ever waits for the other.
+/// Supports one updating thread and one reading thread.
+///
+template<typename T>
+class OutputBuffer : public OutputBufferBase
+{
+public:
+  /// Creates \a count Outputs and snapshots, all set to \a value.
+  explicit OutputBuffer( size_t count, const T &value = T() );
+
+  //=================================================
+  // Updating thread.
+  //=================================================
+
+  /// Returns the Output at \a index, for applying Motions.
+  Output<T>&        operator[] ( size_t index ) { return _outputs[index]; }
+  const Output<T>&  operator[] ( size_t index ) const { return _outputs[index]; }
+
+  size_t            size() const { return _outputs.size(); }
+
+  void publish() override;
+
+  //=================================================
+  // Reading thread.
+  //=================================================
+
+  /// Returns the most recently published snapshot.
+  /// The snapshot stays unchanged until the next call to read().
+  const std::vector<T>& read();
+
+private:
+  static const unsigned IndexMask = 3;
+  /// Set on _latest when the snapshot it names hasn't been read yet.
+  static const unsigned FreshBit = 4;
+
+  std::vector<Output<T>>  _outputs;
+  std::vector<T>          _snapshots[3];
+  /// Snapshot being written by publish(). Owned by the updating thread.
+  unsigned                _back = 0;
+  /// Most recently published snapshot, plus FreshBit. Exchanged by both threads.
+  std::atomic<unsigned>   _latest{ 1 };
+  /// Snapshot returned by read(). Owned by the reading thread.
+  unsigned                _front = 2;
+};
+
+//=================================================
+// OutputBuffer Template Implementation.
+//=================================================
+
+template<typename T>
+OutputBuffer<T>::OutputBuffer( size_t count, const T &value )
+{
+  _outputs.reserve( count );
+  for( size_t i = 0; i < count; i += 1 ) {
+    _outputs.emplace_back( value );
+  }
+
+  for( auto &snapshot : _snapshots ) {
+    snapshot.assign( count, value );
+  }
+}
+
+template<typename T>
+void OutputBuffer<T>::publish()
+{
+  auto &snapshot = _snapshots[_back];
+  for( size_t i = 0; i < _outputs.size(); i += 1 ) {
+    snapshot[i] = _outputs[i].value();
+  }
+  _back = _latest.exchange( _back | FreshBit, std::memory_order_acq_rel ) & IndexMask;
+}
+
+template<typename T>
+const std::vector<T>& OutputBuffer<T>::read()
+{
+  if( _latest.load( std::memory_order_relaxed ) & FreshBit ) {
+    _front = _latest.exchange( _front, std::memory_order_acq_rel ) & IndexMask;
+  }
+  return _snapshots[_front];
+}
+
+} // namespace choreograph
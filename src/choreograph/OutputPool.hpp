@@ -0,0 +1,176 @@
+/*
+ * Copyright (c) 2014 David Wicks, sansumbrella.com
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include "Motion.hpp"
+#include <algorithm>
+#include <memory>
+
+namespace choreograph
+{
+
+///
+/// A fixed number of outputs whose values are stored contiguously.
+/// Motions connect to pool elements the way they connect to Outputs: applying a Motion
+/// to an element disconnects the previous one, and destroying the pool disconnects them all.
+///
+/// Values and connections live in separate arrays allocated once, so data() can be copied
+/// straight into a vertex buffer, and element addresses stay put when the pool is moved.
+///
+/// Motions flag the elements whose values they change. Flags accumulate until clearChanged(),
+/// so consumers can upload or lay out only the elements that changed since they last looked.
+///
+template<typename T>
+class OutputPool
+{
+public:
+  /// Creates \a count elements set to \a value.
+  explicit OutputPool( size_t count, const T &value = T() );
+  /// Disconnects all Motions.
+  ~OutputPool();
+
+  OutputPool( OutputPool &&rhs );
+  OutputPool& operator= ( OutputPool &&rhs );
+  OutputPool( const OutputPool &rhs ) = delete;
+  OutputPool& operator= ( const OutputPool &rhs ) = delete;
+
+  size_t    size() const { return _size; }
+
+  /// Returns the contiguous array of size() values.
+  const T*  data() const { return _values.get(); }
+  T*        data() { return _values.get(); }
+
+  const T&  operator[] ( size_t index ) const { return _values[index]; }
+  T&        operator[] ( size_t index ) { return _values[index]; }
+
+  /// Returns true iff the element at \a index has a Motion input.
+  bool        isConnected( size_t index ) const { return _inputs[index] != nullptr; }
+  /// Returns the Motion connected to the element at \a index, if any.
+  Motion<T>*  inputPtr( size_t index ) { return _inputs[index]; }
+  /// Disconnects the Motion connected to the element at \a index, if any.
+  void        disconnect( size_t index );
+
+  /// Returns true if a Motion changed the element at \a index since the last clearChanged().
+  bool        changed( size_t index ) const { return _changed[index] != 0; }
+  /// Calls \a fn( index ) for each element changed since the last clearChanged(), in order.
+  template<typename Fn>
+  void        forEachChanged( const Fn &fn ) const;
+  /// Clears all change flags.
+  void        clearChanged() { std::fill( _changed.get(), _changed.get() + _size, uint8_t( 0 ) ); }
+
+  /// Returns the connection point for the element at \a index. Used by Motion and Timeline.
+  detail::OutputSlot<T> slot( size_t index ) { return detail::OutputSlot<T>{ &_values[index], &_inputs[index], &_changed[index], nullptr }; }
+
+private:
+  std::unique_ptr<T[]>          _values;
+  std::unique_ptr<Motion<T>*[]> _inputs;
+  /// One byte per element, so Motions evaluated in parallel never write the same word.
+  std::unique_ptr<uint8_t[]>    _changed;
+  size_t                        _size = 0;
+
+  void disconnectAll();
+};
+
+//=================================================
+// OutputPool Template Implementation.
+//=================================================
+
+template<typename T>
+OutputPool<T>::OutputPool( size_t count, const T &value ):
+  _values( new T[count] ),
+  _inputs( new Motion<T>*[count] ),
+  _changed( new uint8_t[count] ),
+  _size( count )
+{
+  for( size_t i = 0; i < count; i += 1 ) {
+    _values[i] = value;
+    _inputs[i] = nullptr;
+  }
+  clearChanged();
+}
+
+template<typename T>
+OutputPool<T>::~OutputPool()
+{
+  disconnectAll();
+}
+
+template<typename T>
+OutputPool<T>::OutputPool( OutputPool &&rhs ):
+  _values( std::move( rhs._values ) ),
+  _inputs( std::move( rhs._inputs ) ),
+  _changed( std::move( rhs._changed ) ),
+  _size( rhs._size )
+{
+  rhs._size = 0;
+}
+
+template<typename T>
+OutputPool<T>& OutputPool<T>::operator= ( OutputPool &&rhs )
+{
+  if( this != &rhs )
+  {
+    disconnectAll();
+    _values = std::move( rhs._values );
+    _inputs = std::move( rhs._inputs );
+    _changed = std::move( rhs._changed );
+    _size = rhs._size;
+    rhs._size = 0;
+  }
+  return *this;
+}
+
+template<typename T>
+void OutputPool<T>::disconnect( size_t index )
+{
+  if( _inputs[index] ) {
+    // Motion::disconnect also nullifies our pointer to the input.
+    _inputs[index]->disconnect();
+  }
+}
+
+template<typename T>
+template<typename Fn>
+void OutputPool<T>::forEachChanged( const Fn &fn ) const
+{
+  for( size_t i = 0; i < _size; i += 1 ) {
+    if( _changed[i] ) {
+      fn( i );
+    }
+  }
+}
+
+template<typename T>
+void OutputPool<T>::disconnectAll()
+{
+  for( size_t i = 0; i < _size; i += 1 ) {
+    disconnect( i );
+  }
+}
+
+} // namespace choreograph
@@ -28,6 +28,8 @@
 #pragma once
 
 #include "TimeType.h"
+#include "detail/Pool.hpp"
+#include <algorithm>
 
 namespace choreograph
 {
@@ -48,6 +50,34 @@ T lerpT( const T &a, const T &b, float t )
   return a + (b - a) * t;
 }
 
+/// Functor edition of lerpT, for use as a template argument.
+template<typename T>
+struct Lerp{ T operator()( const T &a, const T &b, float t ) const { return lerpT<T>( a, b, t ); } };
+
+namespace detail
+{
+
+/// Number of times generated at once by sampleEvenly().
+const size_t SampleChunkSize = 64;
+
+/// Calls \a get_values( times, out, n ) on chunks of \a count times, starting at \a start and \a step apart.
+/// Keeps the generated times on the stack.
+template<typename T, typename Fn>
+void sampleEvenly( Time start, Time step, size_t count, T *out, const Fn &get_values )
+{
+  Time times[SampleChunkSize];
+  for( size_t offset = 0; offset < count; offset += SampleChunkSize )
+  {
+    const auto n = std::min( SampleChunkSize, count - offset );
+    for( size_t i = 0; i < n; i += 1 ) {
+      times[i] = start + (offset + i) * step;
+    }
+    get_values( times, out + offset, n );
+  }
+}
+
+} // namespace detail
+
 ///
 /// A Phrase of motion.
 /// Virtual base class with concept of value and implementation of time.
@@ -79,6 +109,32 @@ public:
   /// Override to provide value at end (and beyond).
   virtual T getEndValue() const { return getValue( getDuration() ); }
 
+  /// Override to report a span of time around \a at_time over which getValue() returns the same value.
+  /// Returns false if the value may be changing at \a at_time. The span may extend past the Phrase's ends.
+  /// Lets Motions sleep through stretches where they have nothing to write.
+  virtual bool getConstantSpan( Time /*at_time*/, Time * /*begin*/, Time * /*end*/ ) const { return false; }
+
+  /// Returns true if getValue() only reads the Phrase's own unchanging state, so it can run on worker threads.
+  /// Override to return false if evaluating calls user code that may have side effects or reads values animated elsewhere.
+  /// Motions playing a Sequence with any such Phrase are evaluated on the updating thread. See Timeline::setParallelExecutor().
+  virtual bool isThreadSafe() const { return true; }
+
+  /// Writes the value at each of the \a count \a times to \a out.
+  /// Override to evaluate many times with a tighter loop than repeated calls to getValue().
+  /// Overrides may ease with easeBatch(), so values can differ from getValue()'s by BatchEaseTolerance of the Phrase's range.
+  virtual void getValues( const Time *times, T *out, size_t count ) const
+  {
+    for( size_t i = 0; i < count; i += 1 ) {
+      out[i] = getValue( times[i] );
+    }
+  }
+
+  /// Writes the values at \a count times to \a out, starting at \a start and \a step apart.
+  void sample( Time start, Time step, size_t count, T *out ) const
+  {
+    detail::sampleEvenly( start, step, count, out, [this] ( const Time *times, T *values, size_t n ) { getValues( times, values, n ); } );
+  }
+
   //=================================================
   // Time querying.
   //=================================================
@@ -29,8 +29,11 @@
 
 #include "Phrase.hpp"
 #include "phrase/Hold.hpp"
+#include "phrase/Ramp.hpp"
 #include "phrase/Retime.hpp"
+#include <algorithm>
 #include <assert.h>
+#include <limits>
 
 namespace choreograph
 {
@@ -50,6 +53,61 @@ using SequenceRef = std::shared_ptr<Sequence<T>>;
 template<typename T>
 using SequenceUniqueRef = std::unique_ptr<Sequence<T>>;
 
+///
+/// Remembers which Phrase a previous Sequence lookup landed in.
+/// Lookups that start from a cursor check the neighborhood of the previous Phrase
+/// before searching the whole Sequence, so sequential lookups are amortized O(1).
+/// Cursors never go stale: after edits to the Sequence they only cost a search.
+///
+struct SequenceCursor
+{
+  /// Index of the Phrase found by the last lookup.
+  size_t index = 0;
+};
+
+namespace detail
+{
+
+/// Returns the index of the first of \a count \a end_times at or after \a time, or the last index if there is none.
+/// \a count must be positive.
+inline size_t phraseIndexAtTime( const Time *end_times, size_t count, Time time )
+{
+  auto iter = std::lower_bound( end_times, end_times + count, time );
+  return (iter == end_times + count) ? count - 1 : iter - end_times;
+}
+
+/// Like phraseIndexAtTime(), but checks the neighborhood of \a cursor first and moves \a cursor to the result.
+/// Returns 0 if \a count is zero.
+inline size_t seekPhrase( const Time *end_times, size_t count, Time time, SequenceCursor &cursor )
+{
+  if( count == 0 ) {
+    cursor.index = 0;
+    return 0;
+  }
+
+  // Playheads usually stay in their phrase or move into a neighbor, so look nearby first.
+  const auto last = count - 1;
+  auto index = std::min( cursor.index, last );
+  for( int steps = 0; steps < 4; steps += 1 )
+  {
+    if( index < last && end_times[index] < time ) {
+      index += 1;
+    }
+    else if( index > 0 && end_times[index - 1] >= time ) {
+      index -= 1;
+    }
+    else {
+      cursor.index = index;
+      return index;
+    }
+  }
+
+  cursor.index = phraseIndexAtTime( end_times, count, time );
+  return cursor.index;
+}
+
+} // namespace detail
+
 ///
 /// A Sequence of motions.
 /// Our essential compositional tool, describing all the transformations to one element.
@@ -82,18 +140,21 @@ public:
   /// Construct a Sequence from a single Phrase.
   explicit Sequence( const PhraseRef<T> &phrase ) :
     _phrases( 1, phrase ),
+    _end_times( 1, phrase->getDuration() ),
     _initial_value( phrase->getStartValue() ),
-    _duration( phrase->getDuration() )
+    _unsafe_phrases( phrase->isThreadSafe() ? 0 : 1 )
   {}
 
   /// Construct a Sequence from a vector of phrases.
   /// A bug in VS2013 causes this constructor to be called when you meant to use
   /// the single-phrase constructor. Cast to PhraseRef<T> to get around it.
   explicit Sequence( const std::vector<PhraseRef<T>> &phrases ):
-    _phrases( phrases ),
+    _phrases( phrases.begin(), phrases.end() ),
     _initial_value( phrases.front()->getStartValue() ),
-    _duration( calcDuration() )
-  {}
+    _unsafe_phrases( countUnsafe( phrases.begin(), phrases.end() ) )
+  {
+    calcEndTimes( 0 );
+  }
 
   //
   // Sequence manipulation and expansion.
@@ -113,6 +174,22 @@ public:
   template<template <typename> class PhraseT, typename... Args>
   Sequence<T>& then( const T &value, Time duration, Args&&... args );
 
+  /// Append a ramp to \a value over \a duration.
+  /// The ramp's type is deduced from \a ease_fn and \a lerp_fn, so functors are called without indirection.
+  /// Example calls look like:
+  /// sequence.rampTo( targetValue, duration, EaseInOutQuad() );
+  template<typename EaseT = EaseNone, typename LerpT = Lerp<T>>
+  Sequence<T>& rampTo( const T &value, Time duration, EaseT ease_fn = EaseT(), LerpT lerp_fn = LerpT() ) { return then( detail::make_pooled<StaticRampTo<T, EaseT, LerpT>>( duration, getEndValue(), value, ease_fn, lerp_fn ) ); }
+
+  /// Append \a count ramps, where ramp i goes to \a values[i] over \a durations[i] starting from the previous end value.
+  /// The ramps are StaticRampTo phrases laid out contiguously in one allocation, which lives as long as any of them.
+  /// Much faster than calling rampTo() for each when building long Sequences.
+  template<typename EaseT = EaseNone, typename LerpT = Lerp<T>>
+  Sequence<T>& rampsTo( const T *values, const Time *durations, size_t count, EaseT ease_fn = EaseT(), LerpT lerp_fn = LerpT() );
+
+  /// Reserve room for \a phrase_count Phrases, so appending up to that many doesn't reallocate.
+  void reserve( size_t phrase_count ) { _phrases.reserve( phrase_count ); _end_times.reserve( phrase_count ); }
+
   /// Append an existing phrase to the Sequence.
   Sequence<T>& then( const PhraseRef<T> &phrase_ptr );
 
@@ -125,7 +202,7 @@ public:
 
   /// Returns a Phrase that encapsulates this Sequence.
   /// Duplicates the Sequence, so future changes to this do not affect the Phrase.
-  PhraseRef<T> asPhrase() const { return std::make_shared<SequencePhrase<T>>( *this ); }
+  PhraseRef<T> asPhrase() const { return detail::make_pooled<SequencePhrase<T>>( *this ); }
 
   /// Returns a Sequence containing the phrases between Times from and to.
   /// Partial phrases at the beginning and end are wrapped in ClipPhrases.
@@ -139,7 +216,7 @@ public:
 
   /// Returns a shared_ptr to the phrase at the requested index.
   /// Throws an exception if the index provided is out of bounds.
-  PhraseRef<T> getPhraseAtIndex( size_t index ) { return _phrases.at( index ); }
+  PhraseRef<T> getPhraseAtIndex( size_t index ) const { return _phrases.at( index ); }
   /// Returns the phrase at the requested time.
   /// If the time is past duration, returns the last phrase in the Sequence.
   /// If there are no phrases in the sequence, behavior is undefined (asserts in debug builds).
@@ -152,6 +229,26 @@ public:
   /// Returns the Sequence value at \a atTime.
   T getValue( Time atTime ) const;
 
+  /// Returns the Sequence value at \a atTime, searching for the Phrase from \a cursor.
+  /// Moves \a cursor to the Phrase at \a atTime.
+  T getValue( Time atTime, SequenceCursor &cursor ) const;
+
+  /// Finds the span of time around \a atTime over which the Sequence value doesn't change, starting the search from \a cursor.
+  /// Returns false if the value may be changing at \a atTime. Spans don't extend past the Phrase at \a atTime.
+  bool getConstantSpan( Time atTime, SequenceCursor &cursor, Time *begin, Time *end ) const;
+
+  /// Writes the Sequence value at each of the \a count \a times to \a out.
+  /// Consecutive times that fall in the same Phrase are evaluated together by Phrase::getValues(),
+  /// so values may differ from getValue()'s as described there.
+  /// Fastest when \a times are sorted, but accepts times in any order.
+  void getValues( const Time *times, T *out, size_t count ) const;
+
+  /// Writes the Sequence values at \a count times to \a out, starting at \a start and \a step apart.
+  void sample( Time start, Time step, size_t count, T *out ) const
+  {
+    detail::sampleEvenly( start, step, count, out, [this] ( const Time *times, T *values, size_t n ) { getValues( times, values, n ); } );
+  }
+
   /// Returns the Sequence value at \a atTime, wrapped past the end of .
   T getValueWrapped( Time time, Time inflectionPoint = 0.0f ) const { return getValue( wrapTime( time, getDuration(), inflectionPoint ) ); }
 
@@ -162,7 +259,10 @@ public:
   T getStartValue() const { return _phrases.empty() ? _initial_value : _phrases.front()->getStartValue(); }
 
   /// Returns the Sequence duration.
-  Time getDuration() const { return _duration; }
+  Time getDuration() const { return _end_times.empty() ? 0 : _end_times.back(); }
+
+  /// Returns true if every Phrase is thread safe, so the Sequence can be evaluated on worker threads. See Phrase::isThreadSafe().
+  bool isThreadSafe() const { return _unsafe_phrases == 0; }
 
   //
   //
@@ -174,6 +274,10 @@ public:
 
   Time getTimeAtInflection( size_t inflection ) const;
 
+  /// Moves \a cursor to the Phrase at \a time and returns that Phrase's index.
+  /// Uses the same rules as getInflectionPoints(). Returns 0 if the Sequence is empty.
+  size_t seek( Time time, SequenceCursor &cursor ) const;
+
   /// Returns the number of phrases in the Sequence.
   size_t getPhraseCount() const { return _phrases.size(); }
   size_t size() const { return _phrases.size(); }
@@ -184,9 +288,23 @@ public:
 
 private:
   // Storing shared_ptr's to Phrases requires their duration to be immutable.
-  std::vector<PhraseRef<T>> _phrases;
-  T                         _initial_value;
-  Time                      _duration = 0;
+  detail::PooledVector<PhraseRef<T>> _phrases;
+  // Time at which each Phrase ends. Lets us find the Phrase at a time with a binary search.
+  detail::PooledVector<Time>         _end_times;
+  T                                  _initial_value;
+  // Number of Phrases that aren't thread safe.
+  size_t                             _unsafe_phrases = 0;
+
+  /// Returns the number of Phrases in [begin, end) that aren't thread safe.
+  template<typename IterT>
+  static size_t countUnsafe( IterT begin, IterT end ) { return std::count_if( begin, end, [] ( const PhraseRef<T> &phrase ) { return ! phrase->isThreadSafe(); } ); }
+  /// Returns the index of the Phrase playing at \a time.
+  /// Phrases own their end time. Times past the end belong to the last Phrase.
+  size_t getPhraseIndexAtTime( Time time ) const;
+  /// Returns the time at which the Phrase at \a index begins.
+  Time getPhraseStartTime( size_t index ) const { return index == 0 ? 0 : _end_times[index - 1]; }
+  /// Recalculates Phrase end times from \a index to the end of the Sequence.
+  void calcEndTimes( size_t index );
 };
 
 //=================================================
@@ -209,8 +327,42 @@ template<typename T>
 template<template <typename> class PhraseT, typename... Args>
 Sequence<T>& Sequence<T>::then( const T &value, Time duration, Args&&... args )
 {
-  _phrases.emplace_back( std::make_shared<PhraseT<T>>( duration, this->getEndValue(), value, std::forward<Args>(args)... ) );
-  _duration += duration;
+  _phrases.emplace_back( detail::make_pooled<PhraseT<T>>( duration, this->getEndValue(), value, std::forward<Args>(args)... ) );
+  _end_times.push_back( getDuration() + _phrases.back()->getDuration() );
+  _unsafe_phrases += countUnsafe( _phrases.end() - 1, _phrases.end() );
+
+  return *this;
+}
+
+template<typename T>
+template<typename EaseT, typename LerpT>
+Sequence<T>& Sequence<T>::rampsTo( const T *values, const Time *durations, size_t count, EaseT ease_fn, LerpT lerp_fn )
+{
+  using RampT = StaticRampTo<T, EaseT, LerpT>;
+  if( count == 0 ) {
+    return *this;
+  }
+
+  // Phrases share ownership of the block through aliasing shared_ptrs.
+  auto block = std::make_shared<std::vector<RampT>>();
+  block->reserve( count );
+  // Grow geometrically, so repeated small calls stay amortized O(1) per Phrase.
+  const auto needed = _phrases.size() + count;
+  if( _phrases.capacity() < needed ) {
+    reserve( std::max( needed, _phrases.size() * 2 ) );
+  }
+
+  auto start_value = getEndValue();
+  auto end_time = getDuration();
+  for( size_t i = 0; i < count; i += 1 )
+  {
+    block->emplace_back( durations[i], start_value, values[i], ease_fn, lerp_fn );
+    auto &ramp = block->back();
+    start_value = values[i];
+    end_time += ramp.getDuration();
+    _phrases.emplace_back( block, &ramp );
+    _end_times.push_back( end_time );
+  }
 
   return *this;
 }
@@ -219,7 +371,8 @@ template<typename T>
 Sequence<T>& Sequence<T>::then( const PhraseRef<T> &phrase )
 {
   _phrases.push_back( phrase );
-  _duration += phrase->getDuration();
+  _end_times.push_back( getDuration() + phrase->getDuration() );
+  _unsafe_phrases += countUnsafe( _phrases.end() - 1, _phrases.end() );
 
   return *this;
 }
@@ -227,13 +380,39 @@ Sequence<T>& Sequence<T>::then( const PhraseRef<T> &phrase )
 template<typename T>
 Sequence<T>& Sequence<T>::then( const Sequence<T> &next )
 {
+  // Copy first, since next may be this Sequence.
+  auto offset = getDuration();
   auto phrases = next._phrases;
+  auto end_times = next._end_times;
+
   _phrases.insert( _phrases.end(), phrases.begin(), phrases.end() );
-  _duration = calcDuration();
+  for( auto &end : end_times ) {
+    _end_times.push_back( offset + end );
+  }
+  _unsafe_phrases += next._unsafe_phrases;
 
   return *this;
 }
 
+template<typename T>
+size_t Sequence<T>::getPhraseIndexAtTime( Time time ) const
+{
+  assert( ! _end_times.empty() );
+  return detail::phraseIndexAtTime( _end_times.data(), _end_times.size(), time );
+}
+
+template<typename T>
+void Sequence<T>::calcEndTimes( size_t index )
+{
+  _end_times.resize( _phrases.size() );
+
+  Time end = getPhraseStartTime( index );
+  for( size_t i = index; i < _phrases.size(); i += 1 ) {
+    end += _phrases[i]->getDuration();
+    _end_times[i] = end;
+  }
+}
+
 template<typename T>
 PhraseRef<T> Sequence<T>::getPhraseAtTime( Time time )
 {
@@ -247,22 +426,27 @@ PhraseRef<T> Sequence<T>::getPhraseAtTime( Time time )
     return _phrases.back();
   }
 
-  for( const auto &phrase : _phrases )
+  return _phrases[getPhraseIndexAtTime( time )];
+}
+
+template<typename T>
+T Sequence<T>::getValue( Time atTime ) const
+{
+  if( atTime < 0 )
   {
-    if( phrase->getDuration() < time ) {
-      time -= phrase->getDuration();
-    }
-    else {
-      return phrase;
-    }
+    return _initial_value;
+  }
+  else if ( atTime >= this->getDuration() )
+  {
+    return getEndValue();
   }
 
-  // Should be unreachable.
-  return _phrases.back();
+  auto index = getPhraseIndexAtTime( atTime );
+  return _phrases[index]->getValue( atTime - getPhraseStartTime( index ) );
 }
 
 template<typename T>
-T Sequence<T>::getValue( Time atTime ) const
+T Sequence<T>::getValue( Time atTime, SequenceCursor &cursor ) const
 {
   if( atTime < 0 )
   {
@@ -273,18 +457,85 @@ T Sequence<T>::getValue( Time atTime ) const
     return getEndValue();
   }
 
-  for( const auto &phrase : _phrases )
+  auto index = seek( atTime, cursor );
+  return _phrases[index]->getValue( atTime - getPhraseStartTime( index ) );
+}
+
+template<typename T>
+bool Sequence<T>::getConstantSpan( Time atTime, SequenceCursor &cursor, Time *begin, Time *end ) const
+{
+  const auto duration = getDuration();
+  if( atTime < 0 )
+  {
+    *begin = - std::numeric_limits<Time>::infinity();
+    *end = 0;
+    return true;
+  }
+  else if( atTime >= duration )
+  {
+    *begin = duration;
+    *end = std::numeric_limits<Time>::infinity();
+    return true;
+  }
+
+  const auto index = seek( atTime, cursor );
+  const auto start = getPhraseStartTime( index );
+  if( ! _phrases[index]->getConstantSpan( atTime - start, begin, end ) ) {
+    return false;
+  }
+
+  // Times outside the Phrase belong to its neighbors.
+  *begin = std::max( start + *begin, start );
+  *end = std::min( start + *end, _end_times[index] );
+  return true;
+}
+
+template<typename T>
+void Sequence<T>::getValues( const Time *times, T *out, size_t count ) const
+{
+  const auto duration = getDuration();
+  SequenceCursor cursor;
+  Time local_times[detail::SampleChunkSize];
+
+  size_t i = 0;
+  while( i < count )
   {
-    if( phrase->getDuration() < atTime ) {
-      atTime -= phrase->getDuration();
+    const auto t = times[i];
+    if( t < 0 ) {
+      out[i] = _initial_value;
+      i += 1;
+      continue;
     }
-    else {
-      return phrase->getValue( atTime );
+    else if( t >= duration ) {
+      out[i] = getEndValue();
+      i += 1;
+      continue;
+    }
+
+    // Gather the following times that land in the same phrase.
+    const auto index = seek( t, cursor );
+    const auto start = getPhraseStartTime( index );
+    const auto end = _end_times[index];
+    size_t n = 0;
+    while( n < detail::SampleChunkSize && i + n < count )
+    {
+      const auto u = times[i + n];
+      if( u < 0 || u >= duration || u > end || (u <= start && index != 0) ) {
+        break;
+      }
+      local_times[n] = u - start;
+      n += 1;
     }
+
+    _phrases[index]->getValues( local_times, out + i, n );
+    i += n;
   }
-  // past the end, get the final value
-  // this should be unreachable, given that we return early if time >= duration
-  return getEndValue();
+}
+
+template<typename T>
+size_t Sequence<T>::seek( Time time, SequenceCursor &cursor ) const
+{
+  return detail::seekPhrase( _end_times.data(), _end_times.size(), time, cursor );
 }
 
 template<typename T>
@@ -300,57 +551,27 @@ Time Sequence<T>::calcDuration() const
 template<typename T>
 std::pair<size_t, size_t> Sequence<T>::getInflectionPoints( Time t1, Time t2 ) const
 {
-  auto output = std::make_pair<size_t, size_t>( 0, 0 );
-  auto set = std::make_pair( false, false );
-
-  for( size_t i = 0; i < _phrases.size(); i += 1 )
-  {
-    const auto duration = _phrases.at( i )->getDuration();
-
-    if( duration < t1 ) {
-      t1 -= duration;
-    }
-    else if( ! set.first ) {
-      output.first = i;
-      set.first = true;
-    }
-
-    if( duration < t2 ) {
-      t2 -= duration;
-    }
-    else if( ! set.second ) {
-      output.second = i;
-      set.second = true;
-    }
-
-    if( set.first && set.second ) {
-      break;
-    }
-  }
-
-  if( ! set.second ) {
-    output.second = _phrases.size() - 1;
+  if( _phrases.empty() ) {
+    return std::make_pair<size_t, size_t>( 0, 0 );
   }
 
-  return output;
+  return std::make_pair( getPhraseIndexAtTime( t1 ), getPhraseIndexAtTime( t2 ) );
 }
 
 template<typename T>
 Time Sequence<T>::getTimeAtInflection( size_t inflection ) const
 {
-  Time t = 0;
-  while( inflection != 0 ) {
-    t += _phrases.at( inflection - 1 )->getDuration();
-    inflection -= 1;
+  if( inflection == 0 ) {
+    return 0;
   }
-  return t;
+  return _end_times.at( inflection - 1 );
 }
 
 template<typename T>
 Sequence<T> Sequence<T>::slice( Time from, Time to ) const
 {
   if( _phrases.empty() ) {
-    return Sequence<T>( PhraseRef<T>( std::make_shared<Hold<T>>( to - from, _initial_value ) ) );
+    return Sequence<T>( PhraseRef<T>( detail::make_pooled<Hold<T>>( to - from, _initial_value ) ) );
   }
 
   // the indices of the first and last Phrases in our time range.
@@ -367,14 +588,14 @@ Sequence<T> Sequence<T>::slice( Time from, Time to ) const
     Time t1 = from - getTimeAtInflection( points.first );
     Time t2 = to - getTimeAtInflection( points.second );
 
-    phrases[0] = std::make_shared<ClipPhrase<T>>( first, t1, first->getDuration() );
-    phrases[phrases.size() - 1] = std::make_shared<ClipPhrase<T>>( last, 0, t2 );
+    phrases[0] = detail::make_pooled<ClipPhrase<T>>( first, t1, first->getDuration() );
+    phrases[phrases.size() - 1] = detail::make_pooled<ClipPhrase<T>>( last, 0, t2 );
 
     return Sequence<T>( phrases );
   }
   else {
     Time t = getTimeAtInflection( points.first );
-    return Sequence<T>( PhraseRef<T>( std::make_shared<ClipPhrase<T>>( first, from - t, to - t ) ) );
+    return Sequence<T>( PhraseRef<T>( detail::make_pooled<ClipPhrase<T>>( first, from - t, to - t ) ) );
   }
 }
 
@@ -386,12 +607,15 @@ void Sequence<T>::splice( size_t start_index, size_t phrases_to_remove, const st
   if( last_index > start_index ) {
     auto begin = _phrases.begin() + start_index;
     auto end = _phrases.begin() + last_index;
+    _unsafe_phrases -= countUnsafe( begin, end );
     _phrases.erase( begin, end );
   }
 
   auto begin = _phrases.begin() + start_index;
   _phrases.insert( begin, phrases_to_insert.begin(), phrases_to_insert.end() );
-  _duration = calcDuration();
+  _unsafe_phrases += countUnsafe( phrases_to_insert.begin(), phrases_to_insert.end() );
+  // Phrases before the splice keep their end times.
+  calcEndTimes( start_index );
 }
 
 //=================================================
@@ -413,9 +637,19 @@ public:
   /// Returns the interpolated value at the given time.
   T getValue( Time atTime ) const override { return _sequence.getValue( atTime ); }
 
+  void getValues( const Time *times, T *out, size_t count ) const override { _sequence.getValues( times, out, count ); }
+
+  bool getConstantSpan( Time at_time, Time *begin, Time *end ) const override
+  {
+    SequenceCursor cursor;
+    return _sequence.getConstantSpan( at_time, cursor, begin, end );
+  }
+
   T getStartValue() const override { return _sequence.getStartValue(); }
 
   T getEndValue() const override { return _sequence.getEndValue(); }
+
+  bool isThreadSafe() const override { return _sequence.isThreadSafe(); }
 private:
   Sequence<T>  _sequence;
 };
@@ -0,0 +1,236 @@
+/*
+ * Copyright (c) 2014 David Wicks, sansumbrella.com
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include "TimelineItem.h"
+#include "Sequence.hpp"
+#include "Output.hpp"
+#include <stdexcept>
+
+namespace choreograph
+{
+
+///
+/// StaggeredMotion: Plays one Sequence on many targets, each delayed by its own time offset.
+/// Use in place of a Motion per target when animating large groups with the same Sequence.
+/// The Sequence is shared by all targets, and targets are evaluated together through Sequence::getValues().
+/// Values can therefore differ slightly from a Motion's on phrases with batched eases, see BatchEaseTolerance.
+///
+/// Targets are raw pointers, like Timeline::applyRaw(), and nothing disconnects them.
+/// Each target must stay at the same address until the StaggeredMotion is destroyed or cancelled,
+/// so don't point into a std::vector that may grow, or at Outputs that may be moved.
+/// Storage that never moves, like an OutputPool's data() or a fixed-size array, works well.
+/// Targets are written every step, even when the Timeline evaluates lazily, and values that
+/// don't change aren't rewritten. Changed targets are reported to Timeline::getChangedTargets().
+///
+/// A group holds one copy of the Sequence, one array of targets and offsets, and room to
+/// evaluate one chunk of values, however many targets it plays on.
+///
+template<typename T>
+class StaggeredMotion : public TimelineItem
+{
+public:
+  using SequenceT = Sequence<T>;
+  using Callback  = std::function<void ()>;
+  using OffsetFn  = std::function<Time (size_t index)>;
+
+  StaggeredMotion() = delete;
+
+  /// Plays \a sequence on each of \a targets, delayed by the matching entry in \a offsets.
+  /// Throws std::invalid_argument if \a targets and \a offsets differ in size.
+  StaggeredMotion( const SequenceT &sequence, const std::vector<T*> &targets, const std::vector<Time> &offsets );
+
+  /// Plays \a sequence on each of \a targets, delaying target i by offset_fn( i ).
+  StaggeredMotion( const SequenceT &sequence, const std::vector<T*> &targets, const OffsetFn &offset_fn );
+
+  /// Plays \a sequence on \a count contiguous targets starting at \a first, delaying target i by i * stagger.
+  StaggeredMotion( const SequenceT &sequence, T *first, size_t count, Time stagger );
+
+  /// Returns the duration of the Sequence plus the largest offset.
+  Time getDuration() const final override { return _sequence.getDuration() + _max_offset; }
+
+  /// Returns the Sequence shared by all targets.
+  const SequenceT& getSequence() const { return _sequence; }
+
+  /// Replaces the Sequence shared by all targets. Targets are rewritten at the next step.
+  void setSequence( const SequenceT &sequence );
+
+  /// Returns the number of targets.
+  size_t size() const { return _instances.size(); }
+
+  /// Returns the time offset of the target at \a index.
+  Time getOffset( size_t index ) const { return _instances[index].offset; }
+
+  /// Set a function to be called at each update step, after all targets are written.
+  void setUpdateFn( const Callback &c ) { _update_fn = c; }
+
+  /// Set a function to be called when the last target reaches the end of the Sequence.
+  void setFinishFn( const Callback &c ) { _finish_fn = c; }
+
+  /// Writes every target's value and calls callbacks as appropriate.
+  void update() final override { evaluate(); dispatchCallbacks(); }
+
+  /// Targets are only written when evaluated, so groups can be evaluated in parallel if their Sequence is thread safe.
+  bool supportsParallelEvaluation() const final override { return _sequence.isThreadSafe(); }
+
+  /// Writes every target's value at the current time.
+  void evaluate() final override;
+
+  /// Reports changed targets, then calls update and finish functions as appropriate.
+  void dispatchCallbacks() final override;
+
+private:
+  struct Instance
+  {
+    T     *target;
+    Time  offset;
+    /// True if the last evaluation changed the target's value.
+    bool  changed;
+  };
+
+  SequenceT             _sequence;
+  std::vector<Instance> _instances;
+  Time                  _max_offset = 0;
+  /// Scratch space for evaluating a chunk of targets.
+  std::vector<T>        _values;
+
+  Callback              _update_fn;
+  Callback              _finish_fn;
+
+  /// Finds the largest offset and fills the scratch space with the Sequence's start value.
+  void calcMaxOffset();
+};
+
+//=================================================
+// StaggeredMotion Template Implementation.
+//=================================================
+
+template<typename T>
+StaggeredMotion<T>::StaggeredMotion( const SequenceT &sequence, const std::vector<T*> &targets, const std::vector<Time> &offsets ):
+  _sequence( sequence )
+{
+  if( targets.size() != offsets.size() ) {
+    throw std::invalid_argument( "StaggeredMotion needs one offset per target." );
+  }
+  _instances.reserve( targets.size() );
+  for( size_t i = 0; i < targets.size(); i += 1 ) {
+    _instances.push_back( Instance{ targets[i], offsets[i], false } );
+  }
+  calcMaxOffset();
+}
+
+template<typename T>
+StaggeredMotion<T>::StaggeredMotion( const SequenceT &sequence, const std::vector<T*> &targets, const OffsetFn &offset_fn ):
+  _sequence( sequence )
+{
+  _instances.reserve( targets.size() );
+  for( size_t i = 0; i < targets.size(); i += 1 ) {
+    _instances.push_back( Instance{ targets[i], offset_fn( i ), false } );
+  }
+  calcMaxOffset();
+}
+
+template<typename T>
+StaggeredMotion<T>::StaggeredMotion( const SequenceT &sequence, T *first, size_t count, Time stagger ):
+  _sequence( sequence )
+{
+  _instances.reserve( count );
+  for( size_t i = 0; i < count; i += 1 ) {
+    _instances.push_back( Instance{ first + i, i * stagger, false } );
+  }
+  calcMaxOffset();
+}
+
+template<typename T>
+void StaggeredMotion<T>::setSequence( const SequenceT &sequence )
+{
+  wakeIfParked();
+  _sequence = sequence;
+  calcMaxOffset();
+  durationChanged();
+}
+
+template<typename T>
+void StaggeredMotion<T>::calcMaxOffset()
+{
+  _max_offset = 0;
+  for( auto &instance : _instances ) {
+    _max_offset = std::max( _max_offset, instance.offset );
+  }
+  _values.assign( std::min( detail::SampleChunkSize, _instances.size() ), _sequence.getStartValue() );
+}
+
+template<typename T>
+void StaggeredMotion<T>::evaluate()
+{
+  Time times[detail::SampleChunkSize];
+  const auto now = time();
+
+  for( size_t offset = 0; offset < _instances.size(); offset += detail::SampleChunkSize )
+  {
+    const auto n = std::min( detail::SampleChunkSize, _instances.size() - offset );
+    for( size_t i = 0; i < n; i += 1 ) {
+      times[i] = now - _instances[offset + i].offset;
+    }
+
+    _sequence.getValues( times, _values.data(), n );
+
+    for( size_t i = 0; i < n; i += 1 ) {
+      auto &instance = _instances[offset + i];
+      instance.changed = detail::assignIfChanged( *instance.target, _values[i] );
+    }
+  }
+}
+
+template<typename T>
+void StaggeredMotion<T>::dispatchCallbacks()
+{
+  if( tracksChanges() ) {
+    for( auto &instance : _instances ) {
+      if( instance.changed ) {
+        targetValueChanged( instance.target );
+      }
+    }
+  }
+
+  if( _update_fn ) {
+    _update_fn();
+  }
+
+  if( _finish_fn )
+  {
+    if( forward() && time() >= getDuration() && previousTime() < getDuration() ) {
+      _finish_fn();
+    }
+    else if( backward() && time() <= 0.0f && previousTime() > 0.0f ) {
+      _finish_fn();
+    }
+  }
+}
+
+} // namespace choreograph
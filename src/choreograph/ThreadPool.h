@@ -0,0 +1,232 @@
+/*
+ * Copyright (c) 2014 David Wicks, sansumbrella.com
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace choreograph
+{
+
+///
+/// Runs \a fn over sub-ranges [begin, end) that together cover [0, count).
+/// Sub-ranges may run concurrently. Must not return until every sub-range has finished.
+/// Set one on a Timeline with Timeline::setParallelExecutor() to evaluate Motions in parallel.
+///
+using ParallelExecutor = std::function<void (size_t count, const std::function<void (size_t begin, size_t end)> &fn)>;
+
+///
+/// A fixed set of worker threads that split ranges of work between them.
+/// Workers and the calling thread claim chunks of the range until none remain,
+/// so uneven chunks balance out across threads.
+///
+/// Use getExecutor() to hand the pool to a Timeline.
+/// The pool must outlive any Timeline using its executor.
+///
+/// The pool runs one parallelFor() at a time. Calls from other threads, as from Timelines
+/// sharing the pool, wait for the running one to finish. Calls made from inside a running
+/// job run directly on the calling thread.
+///
+class ThreadPool
+{
+public:
+  /// Creates a pool with \a worker_count threads in addition to the calling thread.
+  /// By default, uses one fewer worker than the hardware supports.
+  explicit ThreadPool( size_t worker_count = defaultWorkerCount() );
+  ~ThreadPool();
+
+  ThreadPool( const ThreadPool &rhs ) = delete;
+  ThreadPool& operator= ( const ThreadPool &rhs ) = delete;
+
+  /// Calls \a fn on chunks of at most \a grain elements covering [0, count).
+  /// The calling thread works alongside the pool and returns once all chunks are done.
+  /// Ranges no larger than \a grain run directly on the calling thread.
+  /// Waits for any parallelFor() running on another thread to finish first.
+  void parallelFor( size_t count, size_t grain, const std::function<void (size_t begin, size_t end)> &fn );
+
+  /// Returns an executor that runs work on this pool in chunks of \a grain elements.
+  ParallelExecutor getExecutor( size_t grain = 1024 );
+
+  /// Returns the number of worker threads, not counting the calling thread.
+  size_t getWorkerCount() const { return _workers.size(); }
+
+  static size_t defaultWorkerCount();
+
+private:
+  struct Job
+  {
+    const std::function<void (size_t, size_t)> *fn;
+    size_t              count;
+    size_t              grain;
+    std::atomic<size_t> next;
+  };
+
+  std::vector<std::thread>  _workers;
+  /// Held for the whole of parallelFor(), so only one job uses _job at a time.
+  std::mutex                _caller_mutex;
+  std::mutex                _mutex;
+  std::condition_variable   _work_available;
+  std::condition_variable   _work_done;
+  Job                       *_job = nullptr;
+  size_t                    _busy_workers = 0;
+  size_t                    _generation = 0;
+  bool                      _stopping = false;
+
+  void workerLoop();
+  void runChunks( Job &job );
+  /// Returns the pool whose job the current thread is running, if any.
+  static const ThreadPool*& runningPool();
+};
+
+//=================================================
+// ThreadPool Implementation.
+//=================================================
+
+inline size_t ThreadPool::defaultWorkerCount()
+{
+  auto hardware = std::thread::hardware_concurrency();
+  return hardware > 1 ? hardware - 1 : 0;
+}
+
+inline ThreadPool::ThreadPool( size_t worker_count )
+{
+  for( size_t i = 0; i < worker_count; i += 1 ) {
+    _workers.emplace_back( [this] { workerLoop(); } );
+  }
+}
+
+inline ThreadPool::~ThreadPool()
+{
+  {
+    std::lock_guard<std::mutex> lock( _mutex );
+    _stopping = true;
+  }
+  _work_available.notify_all();
+
+  for( auto &worker : _workers ) {
+    worker.join();
+  }
+}
+
+inline const ThreadPool*& ThreadPool::runningPool()
+{
+  static thread_local const ThreadPool *pool = nullptr;
+  return pool;
+}
+
+inline void ThreadPool::runChunks( Job &job )
+{
+  auto outer = runningPool();
+  runningPool() = this;
+  while( true )
+  {
+    auto begin = job.next.fetch_add( job.grain );
+    if( begin >= job.count ) {
+      break;
+    }
+    (*job.fn)( begin, std::min( begin + job.grain, job.count ) );
+  }
+  runningPool() = outer;
+}
+
+inline void ThreadPool::workerLoop()
+{
+  size_t seen_generation = 0;
+  std::unique_lock<std::mutex> lock( _mutex );
+
+  while( true )
+  {
+    _work_available.wait( lock, [this, seen_generation] { return _stopping || _generation != seen_generation; } );
+    if( _stopping ) {
+      return;
+    }
+
+    seen_generation = _generation;
+    auto job = _job;
+    if( ! job ) {
+      continue;
+    }
+
+    _busy_workers += 1;
+    lock.unlock();
+    runChunks( *job );
+    lock.lock();
+    _busy_workers -= 1;
+
+    if( _busy_workers == 0 ) {
+      _work_done.notify_all();
+    }
+  }
+}
+
+inline void ThreadPool::parallelFor( size_t count, size_t grain, const std::function<void (size_t, size_t)> &fn )
+{
+  grain = std::max<size_t>( grain, 1 );
+  // Nested calls would wait on the job they are part of, so they run here instead.
+  if( count <= grain || _workers.empty() || runningPool() == this ) {
+    if( count > 0 ) {
+      fn( 0, count );
+    }
+    return;
+  }
+
+  std::lock_guard<std::mutex> caller_lock( _caller_mutex );
+  Job job;
+  job.fn = &fn;
+  job.count = count;
+  job.grain = grain;
+  job.next = 0;
+
+  {
+    std::lock_guard<std::mutex> lock( _mutex );
+    _job = &job;
+    _generation += 1;
+  }
+  _work_available.notify_all();
+
+  runChunks( job );
+
+  // Wait for workers still finishing their chunks, then retract the job so late wakers skip it.
+  std::unique_lock<std::mutex> lock( _mutex );
+  _work_done.wait( lock, [this] { return _busy_workers == 0; } );
+  _job = nullptr;
+}
+
+inline ParallelExecutor ThreadPool::getExecutor( size_t grain )
+{
+  return [this, grain] ( size_t count, const std::function<void (size_t, size_t)> &fn ) {
+    parallelFor( count, grain, fn );
+  };
+}
+
+} // namespace choreograph
@@ -26,7 +26,10 @@
  */
 
 #include "Timeline.h"
+#include "OutputBuffer.hpp"
 #include "detail/VectorManipulation.hpp"
+#include <algorithm>
+#include <cmath>
 
 using namespace choreograph;
 
@@ -39,11 +42,15 @@ class PassthroughTimelineItem : public TimelineItem
 public:
   explicit PassthroughTimelineItem( const TimelineItemRef &item )
   : _item( item )
-  {}
+  {
+    setTypeKey( typeKey() );
+  }
 
   void update() override { _item->step( deltaTime() ); }
   Time getDuration() const override { return _item->getDuration(); }
   const void* getTarget() const override { return _item->getTarget(); }
+
+  static const void* typeKey() { return detail::typeKey<PassthroughTimelineItem>(); }
 private:
   TimelineItemRef _item;
 };
@@ -52,15 +59,98 @@ private:
 
 Timeline::Timeline( Timeline &&rhs )
 : _default_remove_on_finish( std::move( rhs._default_remove_on_finish ) ),
+_motion_storage( std::move( rhs._motion_storage ) ),
 _items( std::move( rhs._items ) ),
+_targets( std::move( rhs._targets ) ),
+_parked( std::move( rhs._parked ) ),
+_park_clock( std::move( rhs._park_clock ) ),
+_park_order( std::move( rhs._park_order ) ),
+_parked_changed( std::move( rhs._parked_changed ) ),
+_duration( std::move( rhs._duration ) ),
+_duration_dirty( std::move( rhs._duration_dirty ) ),
+_shared_items( std::move( rhs._shared_items ) ),
+_changes( std::move( rhs._changes ) ),
+_lazy_evaluation( rhs._lazy_evaluation ),
+_step_counts( rhs._step_counts ),
+_update_phase( rhs._update_phase ),
+_budget_stats( rhs._budget_stats ),
+_priorities_used( rhs._priorities_used ),
+_output_buffers( std::move( rhs._output_buffers ) ),
+_commands( std::move( rhs._commands ) ),
+_handles( rhs._handles ),
 _queue( std::move( rhs._queue ) ),
 _updating( std::move( rhs._updating ) ),
-_finish_fn( std::move( rhs._finish_fn ) )
-{}
+_finish_fn( std::move( rhs._finish_fn ) ),
+_cleared_fn( std::move( rhs._cleared_fn ) ),
+_parallel_executor( std::move( rhs._parallel_executor ) )
+{
+  rhs._handles = nullptr;
+
+  for( auto *buffer : _output_buffers ) {
+    buffer->_timeline = this;
+  }
+
+  // Items report target changes to their parent, which now lives here.
+  for( auto &item : _items ) {
+    item->_parent = this;
+  }
+  for( auto &item : _queue ) {
+    item->_parent = this;
+  }
+  for( auto &parked : _parked ) {
+    parked.item->_parent = this;
+  }
+  for( auto &bucket : _buckets ) {
+    bucket->forEach( [this] ( TimelineItem &item ) { item._parent = this; } );
+  }
+}
+
+OutputBufferBase::~OutputBufferBase()
+{
+  if( _timeline ) {
+    _timeline->detach( *this );
+  }
+}
+
+Timeline::~Timeline()
+{
+  for( auto *buffer : _output_buffers ) {
+    buffer->_timeline = nullptr;
+  }
+
+  if( _handles ) {
+    _handles->eraseAll();
+    _handles->release();
+  }
+}
 
 void Timeline::removeFinishedAndInvalidMotions()
 {
-  detail::erase_if( &_items, [] ( const TimelineItemUniqueRef &motion ) { return (motion->getRemoveOnFinish() && motion->isFinished()) || motion->cancelled(); } );
+  // Cancelled parked items come back here to be removed.
+  releaseUnparked();
+
+  // Idle times assume we keep moving forward, so don't park while playing backward.
+  const bool can_park = deltaTime() >= 0;
+  size_t kept = 0;
+  for( auto &item : _items )
+  {
+    if( (item->getRemoveOnFinish() && item->isFinished()) || item->cancelled() ) {
+      unindexItem( *item );
+      itemLeft( *item );
+      item.reset();
+    }
+    else if( auto idle = can_park ? item->idleTime() : 0 ) {
+      park( std::move( item ), idle );
+    }
+    else if( item->_bucket && item->_bucket->admit( item, _park_clock ) ) {
+      // The bucket took the item.
+    }
+    else {
+      _items[kept] = std::move( item );
+      kept += 1;
+    }
+  }
+  _items.resize( kept );
 }
 
 void Timeline::customSetTime( Time time )
@@ -68,19 +158,164 @@ void Timeline::customSetTime( Time time )
   for( auto &item : _items ) {
     item->setTime( time );
   }
+
+  for( auto &parked : _parked ) {
+    parked.item->setTime( time );
+  }
+
+  for( auto &bucket : _buckets ) {
+    bucket->forEach( [time] ( TimelineItem &item ) { item.setTime( time ); } );
+  }
+  releaseUnparked();
 }
 
 void Timeline::update()
 {
+  if( _changes ) {
+    _changes->clear();
+  }
+  runPostedCommands();
+  _step_counts = detail::StepCounts();
+  wakeDueItems( deltaTime() );
+  stepBuckets( deltaTime() );
   _updating = true;
-  for( auto &item : _items ) {
-    item->step( deltaTime() );
+
+  if( _deadline ) {
+    updateWithin( *_deadline );
+  }
+  else if( _parallel_executor ) {
+    updateParallel();
+  }
+  else {
+    for( auto &item : _items )
+    {
+      Time step;
+      if( item->takeUpdate( deltaTime(), &step ) ) {
+        item->step( step );
+        _step_counts.updated += 1;
+      }
+      else {
+        _step_counts.skipped += 1;
+      }
+    }
   }
   _updating = false;
 
   postUpdate();
 }
 
+void Timeline::updateParallel()
+{
+  const auto dt = deltaTime();
+  const auto count = _items.size();
+
+  _due.resize( count );
+  for( size_t i = 0; i < count; i += 1 )
+  {
+    Time step;
+    _due[i] = _items[i]->takeUpdate( dt, &step );
+    if( _due[i] ) {
+      _items[i]->beginStep( step );
+      _step_counts.updated += 1;
+    }
+    else {
+      _step_counts.skipped += 1;
+    }
+  }
+
+  _parallel_executor( count, [this] ( size_t begin, size_t end ) {
+    for( size_t i = begin; i < end; i += 1 ) {
+      auto &item = _items[i];
+      if( _due[i] && item->supportsParallelEvaluation() && ! item->cancelled() ) {
+        item->evaluate();
+      }
+    }
+  } );
+
+  // Items added from callbacks go to the queue, so indices stay valid.
+  for( size_t i = 0; i < count; i += 1 )
+  {
+    auto &item = _items[i];
+    if( ! _due[i] ) {
+      continue;
+    }
+    if( ! item->cancelled() )
+    {
+      if( item->supportsParallelEvaluation() ) {
+        item->dispatchCallbacks();
+      }
+      else {
+        item->update();
+      }
+    }
+    item->finishStep();
+  }
+}
+
+void Timeline::step( Time dt, const Deadline &deadline )
+{
+  _deadline = &deadline;
+  step( dt );
+  _deadline = nullptr;
+
+  _budget_stats.updated = _step_counts.updated;
+  _budget_stats.skipped = _step_counts.skipped;
+  _budget_stats.deferred = _step_counts.deferred;
+  _budget_stats.overrun = std::max( - deadline.remaining(), 0.0 );
+  if( _budget_stats.overrun > 0 ) {
+    _budget_stats.overrun_steps += 1;
+  }
+}
+
+void Timeline::updateWithin( const Deadline &deadline )
+{
+  const auto dt = deltaTime();
+  const auto count = _items.size();
+
+  // Items deferred last time go first, even ahead of higher priorities, so no item falls behind by more than one step.
+  _step_order.clear();
+  for( auto deferred : { true, false } ) {
+    for( size_t i = 0; i < count; i += 1 ) {
+      if( _items[i]->updateDeferred() == deferred ) {
+        _step_order.push_back( i );
+      }
+    }
+  }
+  if( _priorities_used ) {
+    std::stable_sort( _step_order.begin(), _step_order.end(), [this] ( size_t a, size_t b ) {
+      const auto &lhs = *_items[a];
+      const auto &rhs = *_items[b];
+      if( lhs.updateDeferred() != rhs.updateDeferred() ) {
+        return lhs.updateDeferred();
+      }
+      return lhs.getPriority() > rhs.getPriority();
+    } );
+  }
+
+  detail::DeadlineCheck check( deadline );
+  // Items added from callbacks go to the queue, so indices stay valid.
+  for( auto i : _step_order )
+  {
+    auto &item = _items[i];
+    Time step;
+    if( check.passed() ) {
+      if( item->deferUpdate( dt ) ) {
+        _step_counts.deferred += 1;
+      }
+      else {
+        _step_counts.skipped += 1;
+      }
+    }
+    else if( item->takeUpdate( dt, &step ) ) {
+      item->step( step );
+      _step_counts.updated += 1;
+    }
+    else {
+      _step_counts.skipped += 1;
+    }
+  }
+}
+
 void Timeline::postUpdate()
 {
   bool was_empty = empty();
@@ -110,40 +345,295 @@ void Timeline::postUpdate()
   }
 }
 
+bool Timeline::empty() const
+{
+  for( auto &bucket : _buckets ) {
+    if( ! bucket->empty() ) {
+      return false;
+    }
+  }
+  return _items.empty() && _parked.empty();
+}
+
+size_t Timeline::size() const
+{
+  size_t count = _items.size() + _parked.size();
+  for( auto &bucket : _buckets ) {
+    count += bucket->size();
+  }
+  return count;
+}
+
+void Timeline::clear()
+{
+  for( auto &item : _items ) {
+    releaseHandle( *item );
+  }
+  for( auto &parked : _parked ) {
+    releaseHandle( *parked.item );
+  }
+  for( auto &bucket : _buckets ) {
+    bucket->forEach( [this] ( TimelineItem &item ) { releaseHandle( item ); } );
+  }
+
+  _items.clear();
+  for( auto &bucket : _buckets ) {
+    bucket->clear();
+  }
+  _parked.clear();
+  _parked_changed = false;
+  _targets.clear();
+  _shared_items = 0;
+  childDurationChanged();
+
+  // Queued items survive clear(), so put them back in the index.
+  for( auto &item : _queue ) {
+    indexItem( *item );
+  }
+}
+
 Time Timeline::timeUntilFinish() const
 {
   Time end = 0;
   for( auto &item : _items ) {
     end = std::max( end, item->getTimeUntilFinish() );
   }
+
+  for( auto &parked : _parked ) {
+    end = std::max( end, parked.item->getTimeUntilFinish() );
+  }
+
+  for( auto &bucket : _buckets ) {
+    end = std::max( end, bucket->timeUntilFinish() );
+  }
   return end;
 }
 
 Time Timeline::getDuration() const
 {
+  if( ! _duration_dirty && _shared_items == 0 ) {
+    return _duration;
+  }
+
   Time duration = 0;
   for( auto &item : _items ) {
     duration = std::max( duration, item->getEndTime() );
   }
+
+  for( auto &parked : _parked ) {
+    duration = std::max( duration, parked.item->getEndTime() );
+  }
+
+  for( auto &bucket : _buckets ) {
+    duration = std::max( duration, bucket->getEndTime() );
+  }
+
+  _duration = duration;
+  _duration_dirty = false;
   return duration;
 }
 
+void Timeline::childDurationChanged()
+{
+  // Ancestors of a dirty timeline are already dirty, since recomputing their duration cleans it.
+  if( ! _duration_dirty ) {
+    _duration_dirty = true;
+    durationChanged();
+  }
+}
+
+void Timeline::itemEntered( const TimelineItem &item )
+{
+  if( item.getTypeKey() == PassthroughTimelineItem::typeKey() ) {
+    _shared_items += 1;
+  }
+
+  if( ! _duration_dirty && item.getEndTime() > _duration ) {
+    _duration = item.getEndTime();
+    durationChanged();
+  }
+}
+
+void Timeline::itemLeft( TimelineItem &item )
+{
+  releaseHandle( item );
+
+  if( item.getTypeKey() == PassthroughTimelineItem::typeKey() ) {
+    _shared_items -= 1;
+  }
+
+  // Only removing the latest-ending item can shorten the timeline.
+  if( ! _duration_dirty && item.getEndTime() >= _duration ) {
+    childDurationChanged();
+  }
+}
+
 void Timeline::processQueue()
 {
-  using namespace std;
-  std::copy( make_move_iterator( _queue.begin() ), make_move_iterator( _queue.end() ), back_inserter( _items ) );
+  for( auto &item : _queue ) {
+    itemEntered( *item );
+    _items.emplace_back( std::move( item ) );
+  }
   _queue.clear();
 }
 
-void Timeline::cancel( void *output )
+bool Timeline::dueLater( const ParkedItem &a, const ParkedItem &b )
 {
-  for( auto &item : _items ) {
-    if( item->getTarget() == output ) {
-      item->cancel();
+  return (a.due > b.due) || (a.due == b.due && a.order > b.order);
+}
+
+Time Timeline::nextUpdatePhase()
+{
+  // Golden ratio steps keep successive phases evenly spread however many items there are.
+  _update_phase += 0.6180339887;
+  _update_phase -= std::floor( _update_phase );
+  return _update_phase;
+}
+
+void Timeline::park( TimelineItemUniqueRef &&item, Time idle_time )
+{
+  const auto due = _park_clock + idle_time;
+
+  item->parkAt( _park_clock );
+  _parked.push_back( ParkedItem{ due, _park_order, std::move( item ) } );
+  _park_order += 1;
+  std::push_heap( _parked.begin(), _parked.end(), &Timeline::dueLater );
+}
+
+void Timeline::unpark( TimelineItem &item )
+{
+  item.unparkAt( _park_clock );
+  _parked_changed = true;
+}
+
+void Timeline::releaseUnparked()
+{
+  if( ! _parked_changed ) {
+    return;
+  }
+  _parked_changed = false;
+
+  auto &destination = _updating ? _queue : _items;
+  size_t kept = 0;
+  for( auto &parked : _parked )
+  {
+    if( parked.item->_parked ) {
+      _parked[kept] = std::move( parked );
+      kept += 1;
+    }
+    else {
+      destination.emplace_back( std::move( parked.item ) );
     }
   }
+  _parked.resize( kept );
+  std::make_heap( _parked.begin(), _parked.end(), &Timeline::dueLater );
 
-  for( auto &item : _queue ) {
+  for( auto &bucket : _buckets ) {
+    bucket->releaseUnparked( destination );
+  }
+}
+
+void Timeline::wakeDueItems( Time dt )
+{
+  releaseUnparked();
+
+  _park_clock += dt;
+  // Wake items a hair early rather than let rounding delay a start by a frame.
+  const auto slack = (std::abs( _park_clock ) + std::abs( dt )) * 1.0e-9;
+  // Stepping backward may take any parked item out of its idle span.
+  while( ! _parked.empty() && (dt < 0 || _parked.front().due <= _park_clock + slack) )
+  {
+    std::pop_heap( _parked.begin(), _parked.end(), &Timeline::dueLater );
+    auto item = std::move( _parked.back().item );
+    _parked.pop_back();
+
+    // Catch up to the clock before this step, so the step itself crosses the start.
+    item->unparkAt( _park_clock - dt );
+    _items.emplace_back( std::move( item ) );
+  }
+}
+
+void Timeline::stepBuckets( Time dt )
+{
+  for( auto &bucket : _buckets ) {
+    _step_counts.updated += bucket->step( _park_clock, dt, _parallel_executor, _lazy_evaluation, _changes.get(), _items );
+  }
+}
+
+TimelineItemHandle Timeline::handleFor( TimelineItem &item )
+{
+  if( ! _handles ) {
+    _handles = detail::HandleTable::create();
+  }
+  if( ! item._handle_slot ) {
+    item._handle_slot = _handles->insert( &item ) + 1;
+  }
+  return TimelineItemHandle( _handles, item._handle_slot - 1 );
+}
+
+void Timeline::releaseHandle( TimelineItem &item )
+{
+  if( item._handle_slot ) {
+    _handles->erase( item._handle_slot - 1 );
+    item._handle_slot = 0;
+  }
+}
+
+void Timeline::indexItem( TimelineItem &item )
+{
+  auto target = item.getTarget();
+  item._parent = this;
+  item._change_list = _changes.get();
+  item._lazy = _lazy_evaluation;
+  if( item._priority != 0 ) {
+    _priorities_used = true;
+  }
+  item._indexed_target = target;
+  item._older_with_target = nullptr;
+
+  if( target ) {
+    item._older_with_target = _targets.find( target );
+    _targets.set( target, &item );
+  }
+}
+
+void Timeline::unindexItem( TimelineItem &item )
+{
+  auto target = item._indexed_target;
+  if( target )
+  {
+    auto newest = _targets.find( target );
+    if( newest == &item ) {
+      if( item._older_with_target ) {
+        _targets.set( target, item._older_with_target );
+      }
+      else {
+        _targets.erase( target );
+      }
+    }
+    else {
+      for( auto other = newest; other; other = other->_older_with_target ) {
+        if( other->_older_with_target == &item ) {
+          other->_older_with_target = item._older_with_target;
+          break;
+        }
+      }
+    }
+  }
+
+  item._indexed_target = nullptr;
+  item._older_with_target = nullptr;
+}
+
+void Timeline::retarget( TimelineItem &item )
+{
+  unindexItem( item );
+  indexItem( item );
+}
+
+void Timeline::cancel( void *output )
+{
+  for( auto item = _targets.find( output ); item; item = item->_older_with_target ) {
     if( item->getTarget() == output ) {
       item->cancel();
     }
@@ -153,11 +643,13 @@ void Timeline::cancel( void *output )
 void Timeline::add( TimelineItemUniqueRef &&item )
 {
   item->setRemoveOnFinish( _default_remove_on_finish );
+  indexItem( *item );
 
   if( _updating ) {
     _queue.emplace_back( std::move( item ) );
   }
   else {
+    itemEntered( *item );
     _items.emplace_back( std::move( item ) );
   }
 }
@@ -166,18 +658,124 @@ TimelineOptions Timeline::addShared( const TimelineItemRef &shared )
 {
   auto item = detail::make_unique<PassthroughTimelineItem>( shared );
   item->setRemoveOnFinish( _default_remove_on_finish );
+  indexItem( *item );
   auto &ref = *item;
 
   if( _updating ) {
     _queue.emplace_back( std::move( item ) );
   }
   else {
+    itemEntered( *item );
     _items.emplace_back( std::move( item ) );
   }
 
   return TimelineOptions( ref );
 }
 
+template<typename Fn>
+void Timeline::forEachItem( const Fn &fn )
+{
+  for( auto &item : _items ) {
+    fn( *item );
+  }
+  for( auto &item : _queue ) {
+    fn( *item );
+  }
+  for( auto &parked : _parked ) {
+    fn( *parked.item );
+  }
+  for( auto &bucket : _buckets ) {
+    bucket->forEach( fn );
+  }
+}
+
+void Timeline::setChangeTracking( bool track )
+{
+  if( track == getChangeTracking() ) {
+    return;
+  }
+
+  if( track ) {
+    _changes = detail::make_unique<std::vector<const void*>>();
+  }
+  auto list = track ? _changes.get() : nullptr;
+  forEachItem( [list] ( TimelineItem &item ) { item._change_list = list; } );
+
+  if( ! track ) {
+    _changes.reset();
+  }
+}
+
+void Timeline::setLazyEvaluation( bool lazy )
+{
+  _lazy_evaluation = lazy;
+  forEachItem( [lazy] ( TimelineItem &item ) { item._lazy = lazy; } );
+}
+
+const std::vector<const void*>& Timeline::getChangedTargets() const
+{
+  static const std::vector<const void*> none;
+  return _changes ? *_changes : none;
+}
+
+void Timeline::publish()
+{
+  for( auto *buffer : _output_buffers ) {
+    buffer->publish();
+  }
+}
+
+void Timeline::attach( OutputBufferBase &buffer )
+{
+  if( buffer._timeline == this ) {
+    return;
+  }
+  if( buffer._timeline ) {
+    buffer._timeline->detach( buffer );
+  }
+  _output_buffers.push_back( &buffer );
+  buffer._timeline = this;
+}
+
+void Timeline::detach( OutputBufferBase &buffer )
+{
+  if( buffer._timeline == this ) {
+    detail::vector_remove( &_output_buffers, &buffer );
+    buffer._timeline = nullptr;
+  }
+}
+
+void Timeline::setCommandQueueCapacity( size_t capacity )
+{
+  _commands = detail::make_unique<detail::MPSCQueue<Command>>( capacity );
+}
+
+bool Timeline::post( Command command )
+{
+  if( ! _commands ) {
+    return false;
+  }
+  return _commands->push( std::move( command ) );
+}
+
+bool Timeline::postCue( const std::function<void ()> &fn, Time delay )
+{
+  return post( [fn, delay] ( Timeline &timeline ) { timeline.cue( fn, delay ); } );
+}
+
+void Timeline::runPostedCommands()
+{
+  if( ! _commands ) {
+    return;
+  }
+
+  // Commands posted by these commands wait for the next update.
+  Command command;
+  for( auto count = _commands->size(); count > 0 && _commands->pop( command ); count -= 1 ) {
+    command( *this );
+  }
+}
+
 TimelineOptions Timeline::cue( const std::function<void ()> &fn, Time delay )
 {
   auto cue = detail::make_unique<Cue>( fn, delay );
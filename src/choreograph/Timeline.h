@@ -28,27 +28,77 @@
 #pragma once
 
 #include "TimelineOptions.hpp"
+#include "OutputPool.hpp"
 #include "detail/MakeUnique.hpp"
+#include "detail/MotionBucket.hpp"
+#include "detail/PointerMap.hpp"
+#include "detail/MPSCQueue.hpp"
+#include "ThreadPool.h"
+#include "Deadline.h"
 
 namespace choreograph
 {
 
+class OutputBufferBase;
+
+namespace detail
+{
+
+///
+/// Numbers of items stepped and held back by their update interval during an update.
+///
+struct StepCounts
+{
+  size_t updated = 0;
+  size_t skipped = 0;
+  /// Items held back because a budgeted step ran out of time.
+  size_t deferred = 0;
+};
+
+} // namespace detail
+
+///
+/// How a Timeline stores the Motions it creates.
+///
+enum class MotionStorage
+{
+  /// Each Motion is stepped alongside Cues and other items, in order of creation.
+  Separate,
+  /// While a Motion plays inside one Phrase, its time, speed, start time, target, and Phrase are kept in arrays
+  /// grouped by value type, and each group is evaluated in one loop without touching the Motions.
+  /// Motions leave their group where they cross a Phrase boundary, so the Timeline steps them and fires their callbacks there.
+  /// Motions with an update function or update interval are always stepped separately.
+  /// Use when running very large numbers of Motions of a few types.
+  Bucketed
+};
+
 ///
 /// Timeline holds a collection of TimelineItems and updates them through time.
 /// TimelineItems include Motions and Cues.
 ///
+/// Items that are idle for a stretch of time (see TimelineItem::getIdleSpan()), like delayed Cues
+/// and Motions in a Hold, are parked while idle and are not stepped until the step that ends the stretch.
+/// Parking assumes the Timeline's time moves forward: a step backward wakes every parked item,
+/// and items are parked again only after a step that doesn't go backward.
+/// Woken items are stepped after items that were already stepping, so callbacks from different items
+/// in the same step may run in a different order than the items were added.
+///
 /// TimelineItems can be canceled using a control object retrieved from TimelineOptions.
 /// Additionally, Motions can be cancelled by disconnecting their Output<T>.
 /// Public methods are safe to call from cues and motion callbacks unless otherwise noted.
 ///
 /// Timelines are move-only because they contain unique_ptrs.
 ///
+/// Timeline is not thread-safe, except for the post methods, which queue commands from any thread
+/// to run at the start of the next update(). See setCommandQueueCapacity().
+///
 class Timeline : public TimelineItem
 {
 public:
   Timeline() = default;
   /// VS2013 requires us to define the default move constructor.
   Timeline( Timeline &&rhs );
+  ~Timeline();
   //=================================================
   // Creating Motions. Output<T>* Versions
   //=================================================
@@ -64,10 +114,48 @@ public:
   template<typename T>
   MotionOptions<T> apply( Output<T> *output, const PhraseRef<T> &phrase );
 
+  /// Apply a shared, immutable Sequence to output without copying it.
+  /// Creating many Motions from one Sequence this way costs a pointer copy each.
+  /// A Motion copies the Sequence the first time its own Sequence is modified, as by MotionOptions::then().
+  template<typename T>
+  MotionOptions<T> apply( Output<T> *output, const typename Motion<T>::SharedSequenceRef &sequence );
+
   /// Add phrases to the end of the Sequence currently connected to \a output.
   template<typename T>
   MotionOptions<T> append( Output<T> *output );
 
+  //=================================================
+  // Creating Motions. OutputPool<T> Versions
+  //=================================================
+
+  /// Apply a source to element \a index of \a pool, overwriting any previous connection.
+  template<typename T>
+  MotionOptions<T> apply( OutputPool<T> *pool, size_t index );
+
+  template<typename T>
+  MotionOptions<T> apply( OutputPool<T> *pool, size_t index, const Sequence<T> &sequence );
+
+  /// Apply a shared, immutable Sequence to element \a index of \a pool without copying it.
+  template<typename T>
+  MotionOptions<T> apply( OutputPool<T> *pool, size_t index, const typename Motion<T>::SharedSequenceRef &sequence );
+
+  /// Add phrases to the end of the Sequence currently connected to element \a index of \a pool.
+  template<typename T>
+  MotionOptions<T> append( OutputPool<T> *pool, size_t index );
+
+  //=================================================
+  // Creating StaggeredMotions.
+  //=================================================
+
+  /// Play \a sequence on each of \a targets, delaying each by the matching entry in \a offsets.
+  /// Targets are raw pointers that must stay put until the motion ends or is cancelled. See StaggeredMotion.
+  template<typename T>
+  StaggeredMotionOptions<T> applyStaggered( const std::vector<T*> &targets, const Sequence<T> &sequence, const std::vector<Time> &offsets );
+
+  /// Play \a sequence on each of \a targets, delaying target i by offset_fn( i ).
+  template<typename T>
+  StaggeredMotionOptions<T> applyStaggered( const std::vector<T*> &targets, const Sequence<T> &sequence, const typename StaggeredMotion<T>::OffsetFn &offset_fn );
+
   //=================================================
   // Creating Cues.
   //=================================================
@@ -87,6 +175,83 @@ public:
   /// Use in advanced cases when you want to maintain the TimelineItem outside the Timeline.
   TimelineOptions addShared( const TimelineItemRef &item );
 
+  //=================================================
+  // Change tracking.
+  //=================================================
+
+  /// Set whether to record the targets whose values Motions change during update(). Default is false.
+  /// Motions on nested Timelines are recorded by those Timelines.
+  void setChangeTracking( bool track );
+  bool getChangeTracking() const { return _changes != nullptr; }
+
+  /// Returns the targets Motions changed during the most recent update(), in the order they changed.
+  /// Empty unless change tracking is on.
+  const std::vector<const void*>& getChangedTargets() const;
+
+  //=================================================
+  // Lazy evaluation.
+  //=================================================
+
+  /// Set whether Motions connected to Outputs defer evaluation until the Output is read. Default is false.
+  /// When lazy, stepping advances time and fires callbacks, and each Output evaluates its Motion's Sequence
+  /// the first time it is read after a step. Outputs nobody reads cost no evaluation.
+  /// Motions writing to raw pointers or OutputPools always evaluate while stepping.
+  /// Lazy Motions don't appear in getChangedTargets().
+  void setLazyEvaluation( bool lazy );
+  bool getLazyEvaluation() const { return _lazy_evaluation; }
+
+  //=================================================
+  // Publishing values to other threads.
+  //=================================================
+
+  /// Publishes a snapshot of every attached OutputBuffer. Call after stepping.
+  /// Each buffer's snapshot holds values from a single step, but buffers are swapped in one at a time,
+  /// so a reader of two buffers may see one from this step and the other from the next.
+  /// Keep values that must stay in step in the same buffer.
+  /// Motions write to the buffers' Outputs as usual, and publishing copies every value into a snapshot,
+  /// so each call costs time in proportion to the number of buffered Outputs.
+  void publish();
+
+  /// Attach \a buffer to be published by publish(). Detaches it from any other Timeline.
+  /// Buffers detach themselves when destroyed.
+  void attach( OutputBufferBase &buffer );
+  void detach( OutputBufferBase &buffer );
+
+  //=================================================
+  // Posting commands from other threads.
+  //=================================================
+
+  using Command = std::function<void (Timeline &)>;
+
+  /// Enables the post methods, with room for \a capacity pending commands (rounded up to a power of two).
+  /// Call on the updating thread before other threads post. Discards any pending commands.
+  void setCommandQueueCapacity( size_t capacity );
+
+  /// Queues \a command to be called with this timeline at the start of the next update(). Safe to call from any thread.
+  /// Returns false if the queue is full, counting a drop, or if it was never enabled.
+  bool post( Command command );
+
+  /// Posts a command that applies \a sequence to \a output.
+  template<typename T>
+  bool postApply( Output<T> *output, const Sequence<T> &sequence ) { return post( [output, sequence] ( Timeline &timeline ) { timeline.apply( output, sequence ); } ); }
+
+  /// Posts a command that appends \a sequence to the Sequence connected to \a output.
+  template<typename T>
+  bool postAppend( Output<T> *output, const Sequence<T> &sequence ) { return post( [output, sequence] ( Timeline &timeline ) { timeline.append( output ).then( sequence ); } ); }
+
+  /// Posts a command that disconnects \a output, cancelling its Motion.
+  template<typename T>
+  bool postCancel( Output<T> *output ) { return post( [output] ( Timeline & ) { output->disconnect(); } ); }
+
+  /// Posts a command that cues \a fn after \a delay, measured from when the command runs.
+  bool postCue( const std::function<void ()> &fn, Time delay );
+
+  /// Returns the number of posted commands waiting for the next update(). Approximate while other threads post.
+  size_t getCommandQueueDepth() const { return _commands ? _commands->size() : 0; }
+
+  /// Returns the number of commands rejected because the queue was full.
+  size_t getDroppedCommandCount() const { return _commands ? _commands->dropped() : 0; }
+
   //=================================================
   // Time manipulation.
   //=================================================
@@ -94,15 +259,26 @@ public:
   /// Updates all timeline items to the current time.
   void update() override;
 
+  using TimelineItem::step;
+  /// Steps forward in time by \a dt, stepping items until \a deadline passes.
+  /// Items step in priority order (see TimelineItem::setPriority()). Once the deadline passes, the remaining
+  /// items are deferred: they step first in the next step, ahead of any higher priorities, catching up on the time they missed.
+  /// Motions in buckets (see MotionStorage::Bucketed) are evaluated before any items step and are never deferred.
+  /// Runs on the calling thread, even if a parallel executor is set. Results are in getBudgetStats().
+  void step( Time dt, const Deadline &deadline );
+
+  /// Returns the results of the most recent budgeted step.
+  const BudgetStats& getBudgetStats() const { return _budget_stats; }
+
   //=================================================
   // Timeline querying methods and callbacks.
   //=================================================
 
   /// Returns true iff there are no items on this timeline.
-  bool empty() const { return _items.empty(); }
+  bool empty() const;
 
   /// Returns the number of items on this timeline.
-  size_t size() const { return _items.size(); }
+  size_t size() const;
 
   /// Sets a function to be called when this timeline reaches its end, but is not necessarily empty.
   void setFinishFn( const std::function<void ()> &fn ) { _finish_fn = fn; }
@@ -117,6 +293,12 @@ public:
 
   Time getDuration() const override;
 
+  /// Returns the number of items stepped during the most recent update().
+  size_t getUpdatedItemCount() const { return _step_counts.updated; }
+  /// Returns the number of items held back by their update interval during the most recent update().
+  /// Items parked while idle are in neither count. See TimelineItem::setUpdateInterval().
+  size_t getSkippedItemCount() const { return _step_counts.skipped; }
+
   //=================================================
   // Timeline element manipulation.
   //=================================================
@@ -126,9 +308,24 @@ public:
   /// Does not affect TimelineItems already on the Timeline.
   void setDefaultRemoveOnFinish( bool doRemove ) { _default_remove_on_finish = doRemove; }
 
+  /// Set how Motions created by this timeline are stored. Default is MotionStorage::Separate.
+  /// Affects only Motions created after the call.
+  void setMotionStorage( MotionStorage storage ) { _motion_storage = storage; }
+  MotionStorage getMotionStorage() const { return _motion_storage; }
+
+  /// Set an executor used to evaluate Motion values in parallel during update().
+  /// Values for all Motions are written first, spread across the executor's threads.
+  /// Callbacks, Cues, and other items then run on the updating thread in the same order as without an executor.
+  /// Motions whose Sequences hold a Phrase that isn't thread safe, like ProceduralPhrase or MixPhrase, are evaluated
+  /// on the updating thread with the callbacks. See Phrase::isThreadSafe().
+  /// Ease and lerp functions of other Phrases run on worker threads, so they must not have side effects.
+  /// Buckets of Motions (see MotionStorage::Bucketed) are spread across the executor's threads too, unless one of their Phrases isn't thread safe.
+  /// Pass nullptr to go back to updating everything on the calling thread.
+  void setParallelExecutor( const ParallelExecutor &executor ) { _parallel_executor = executor; }
+
   /// Remove all items from this timeline.
   /// Do not call from a callback.
-  void clear() { _items.clear(); }
+  void clear();
 
   //=================================================
   // Creating Motions. T* Versions.
@@ -144,11 +341,17 @@ public:
   template<typename T>
   MotionOptions<T> applyRaw( T *output, const Sequence<T> &sequence );
 
+  /// Apply a shared, immutable Sequence to output without copying it.
+  template<typename T>
+  MotionOptions<T> applyRaw( T *output, const typename Motion<T>::SharedSequenceRef &sequence );
+
   /// Add phrases to the end of the Sequence currently connected to \a output. Raw pointer edition.
   /// Unless you have a strong need, prefer the use of append( Output<T> *output ) over this version.
   template<typename T>
   MotionOptions<T> appendRaw( T *output );
 
+  /// Iterators over the TimelineItems on this timeline.
+  /// Items parked until they start and Motions evaluated from buckets are not included.
   std::vector<TimelineItemUniqueRef>::iterator begin() { return _items.begin(); }
   std::vector<TimelineItemUniqueRef>::iterator end( ) { return _items.end( ); }
   std::vector<TimelineItemUniqueRef>::const_iterator begin( ) const { return _items.cbegin( ); }
@@ -160,13 +363,89 @@ protected:
 private:
   // True if Motions should be removed from timeline when they reach their endTime.
   bool                                _default_remove_on_finish = true;
+  MotionStorage                       _motion_storage = MotionStorage::Separate;
   std::vector<TimelineItemUniqueRef>  _items;
+  // Newest item for each target, covering _items and _queue.
+  // Older items with the same target are chained through TimelineItem::_older_with_target.
+  detail::PointerMap<TimelineItem>    _targets;
+
+  struct ParkedItem
+  {
+    /// Park clock time at which the item stops being idle.
+    Time                  due;
+    /// Breaks ties between items due at the same time, keeping them in the order they were parked.
+    size_t                order;
+    TimelineItemUniqueRef item;
+  };
+  // Items waiting to start, kept in a min-heap by due time.
+  std::vector<ParkedItem>             _parked;
+  // Sum of the time steps taken by this timeline. Parked items are due relative to it.
+  Time                                _park_clock = 0;
+  size_t                              _park_order = 0;
+  // True if the timing of a parked item changed, so it must return to _items.
+  bool                                _parked_changed = false;
+  // Motions evaluated by value type when using MotionStorage::Bucketed. Parked like the items in _parked.
+  // Buckets are kept until the Timeline is destroyed, since Motions point at theirs.
+  std::vector<std::unique_ptr<detail::MotionBucketBase>>  _buckets;
+
+  // Latest end time of the items in _items, _parked, and _buckets. Recomputed by getDuration() when dirty.
+  mutable Time                        _duration = 0;
+  mutable bool                        _duration_dirty = false;
+  // Number of shared items in _items. Their durations can change without notice, so they disable the cache.
+  size_t                              _shared_items = 0;
+
+  // Targets changed during the last update. Null unless tracking changes.
+  // Items point at it, so it is allocated separately and stays put when the Timeline moves.
+  std::unique_ptr<std::vector<const void*>>  _changes;
+  // True if Motions connected to Outputs leave evaluation to the Output.
+  bool                                _lazy_evaluation = false;
+
+  // Items stepped and skipped by the last update.
+  detail::StepCounts                  _step_counts;
+  // Whether each item in _items is due for an update in the current parallel step.
+  std::vector<uint8_t>                _due;
+  // Fraction of an update interval that the next throttled item waits before its first update.
+  Time                                _update_phase = 0;
+
+  // Deadline for the current budgeted step. Null otherwise.
+  const Deadline                      *_deadline = nullptr;
+  BudgetStats                         _budget_stats;
+  // True once any item has had a non-default priority, so budgeted steps must sort by priority.
+  bool                                _priorities_used = false;
+  // Indices into _items in the order a budgeted step visits them.
+  std::vector<size_t>                 _step_order;
+
+  // Buffers published by publish().
+  std::vector<OutputBufferBase*>      _output_buffers;
+
+  // Commands posted from other threads. Null until setCommandQueueCapacity() is called.
+  std::unique_ptr<detail::MPSCQueue<Command>>  _commands;
+
+  // Slots for handles to our items. Created on first request; outlives us while handles remain.
+  detail::HandleTable                 *_handles = nullptr;
 
   // queue to make adding cues from callbacks safe. Used if modifying functions are called during update loop.
   std::vector<TimelineItemUniqueRef>  _queue;
   bool                                _updating = false;
   std::function<void ()>              _finish_fn = nullptr;
   std::function<void ()>        _cleared_fn = nullptr;
+  ParallelExecutor              _parallel_executor = nullptr;
+
+  // Calls \a fn with every item on the timeline, wherever it is stored.
+  template<typename Fn>
+  void forEachItem( const Fn &fn );
+
+  // Runs the commands that were posted before the call.
+  void runPostedCommands();
+
+  // Steps items in phases, evaluating Motions with the parallel executor.
+  void updateParallel();
+
+  // Steps items in priority order until \a deadline passes, deferring the rest.
+  void updateWithin( const Deadline &deadline );
+
+  // Notes that an item's priority changed.
+  void priorityChanged() { _priorities_used = true; }
 
   // Clean up finished motions and add queued motions after update.
   // Calls finish function if we went from having items to no items this iteration.
@@ -178,7 +457,52 @@ private:
   // Move any items in the queue to our active items collection.
   void processQueue();
 
-  /// Returns a non-owning raw pointer to the Motion applied to \a output, if any.
+  // Returns a phase in [0, 1) for spreading throttled items' updates across steps. See TimelineItem::setUpdateInterval().
+  Time nextUpdatePhase();
+
+  // Move \a item aside until it is due to wake \a idle_time from now.
+  void park( TimelineItemUniqueRef &&item, Time idle_time );
+  // Bring \a item's time up to the park clock and mark it for return to the stepped items.
+  void unpark( TimelineItem &item );
+  // Move items marked by unpark() back into _items, or into _queue while updating. Includes Motions in buckets.
+  void releaseUnparked();
+  // Advance the park clock by \a dt and move items that wake during the step into _items.
+  // Wakes every parked item when \a dt is negative.
+  void wakeDueItems( Time dt );
+  // Evaluate the Motions in buckets after the park clock advanced by \a dt, moving those that left their Phrase into _items.
+  void stepBuckets( Time dt );
+  // Orders the _parked heap so the earliest due item is on top.
+  static bool dueLater( const ParkedItem &a, const ParkedItem &b );
+
+  // Mark the cached duration dirty and tell our parent. Called by items when their duration changes.
+  void childDurationChanged();
+  // Account for \a item joining the stepped items.
+  void itemEntered( const TimelineItem &item );
+  // Account for \a item leaving the timeline.
+  void itemLeft( TimelineItem &item );
+
+  // Returns a handle to \a item, giving it a slot in the handle table if it has none.
+  TimelineItemHandle handleFor( TimelineItem &item );
+  // Invalidates handles to \a item.
+  void releaseHandle( TimelineItem &item );
+
+  // Make this timeline the parent of \a item and add it to the target index.
+  void indexItem( TimelineItem &item );
+  // Remove \a item from the target index.
+  void unindexItem( TimelineItem &item );
+  // Move \a item to its current target in the index. Called when an item's target changes.
+  void retarget( TimelineItem &item );
+  friend class TimelineItem;
+
+  /// Creates a Motion<T> from \a args and adds it to the timeline, assigning it a bucket if using MotionStorage::Bucketed.
+  template<typename T, typename... Args>
+  Motion<T>& createMotion( Args&&... args );
+
+  /// Returns the bucket for Motion<T>s, creating it if there is none.
+  template<typename T>
+  detail::MotionBucketBase& bucketFor();
+
+  /// Returns a non-owning raw pointer to the newest uncancelled Motion applied to \a output, if any.
   /// If there is no Motion applied, returns nullptr.
   /// Used internally when appending to motions.
   template<typename T>
@@ -193,37 +517,80 @@ private:
 // Timeline Template Function Implementation.
 //=================================================
 
-template<typename T>
-MotionOptions<T> Timeline::apply( Output<T> *output )
+template<typename T, typename... Args>
+Motion<T>& Timeline::createMotion( Args&&... args )
 {
-  auto motion = detail::make_unique<Motion<T>>( output );
+  auto motion = detail::make_unique<Motion<T>>( std::forward<Args>( args )... );
+  if( _motion_storage == MotionStorage::Bucketed ) {
+    motion->_bucket = &bucketFor<T>();
+  }
 
   auto &motion_ref = *motion;
   add( std::move( motion ) );
+  return motion_ref;
+}
 
-  return MotionOptions<T>( motion_ref, motion_ref.getSequence(), *this );
+template<typename T>
+detail::MotionBucketBase& Timeline::bucketFor()
+{
+  const auto key = detail::typeKey<Motion<T>>();
+  for( auto &bucket : _buckets ) {
+    if( bucket->getTypeKey() == key ) {
+      return *bucket;
+    }
+  }
+  _buckets.emplace_back( detail::make_unique<detail::MotionBucket<T>>() );
+  return *_buckets.back();
 }
 
 template<typename T>
-MotionOptions<T> Timeline::apply( Output<T> *output, const PhraseRef<T> &phrase )
+StaggeredMotionOptions<T> Timeline::applyStaggered( const std::vector<T*> &targets, const Sequence<T> &sequence, const std::vector<Time> &offsets )
 {
-  auto motion = detail::make_unique<Motion<T>>( output, Sequence<T>( phrase ) );
+  auto motion = detail::make_unique<StaggeredMotion<T>>( sequence, targets, offsets );
+  StaggeredMotionOptions<T> options( *motion );
+  add( std::move( motion ) );
+  return options;
+}
 
-  auto &motion_ref = *motion;
+template<typename T>
+StaggeredMotionOptions<T> Timeline::applyStaggered( const std::vector<T*> &targets, const Sequence<T> &sequence, const typename StaggeredMotion<T>::OffsetFn &offset_fn )
+{
+  auto motion = detail::make_unique<StaggeredMotion<T>>( sequence, targets, offset_fn );
+  StaggeredMotionOptions<T> options( *motion );
   add( std::move( motion ) );
+  return options;
+}
 
-  return MotionOptions<T>( motion_ref, motion_ref.getSequence(), *this );
+template<typename T>
+MotionOptions<T> Timeline::apply( Output<T> *output )
+{
+  auto &motion_ref = createMotion<T>( output );
+
+  return MotionOptions<T>( motion_ref, *this );
+}
+
+template<typename T>
+MotionOptions<T> Timeline::apply( Output<T> *output, const PhraseRef<T> &phrase )
+{
+  auto &motion_ref = createMotion<T>( output, Sequence<T>( phrase ) );
+
+  return MotionOptions<T>( motion_ref, *this );
 }
 
 template<typename T>
 MotionOptions<T> Timeline::apply( Output<T> *output, const Sequence<T> &sequence )
 {
-  auto motion = detail::make_unique<Motion<T>>( output, sequence );
+  auto &motion_ref = createMotion<T>( output, sequence );
 
-  auto &motion_ref = *motion;
-  add( std::move( motion ) );
+  return MotionOptions<T>( motion_ref, *this );
+}
+
+template<typename T>
+MotionOptions<T> Timeline::apply( Output<T> *output, const typename Motion<T>::SharedSequenceRef &sequence )
+{
+  auto &motion_ref = createMotion<T>( output, sequence );
 
-  return MotionOptions<T>( motion_ref, motion_ref.getSequence(), *this );
+  return MotionOptions<T>( motion_ref, *this );
 }
 
 template<typename T>
@@ -231,35 +598,70 @@ MotionOptions<T> Timeline::append( Output<T> *output )
 {
   auto motion = output->inputPtr();
   if( motion ) {
-    return MotionOptions<T>( *motion, motion->getSequence(), *this );
+    return MotionOptions<T>( *motion, *this );
   }
   return apply( output );
 }
 
+template<typename T>
+MotionOptions<T> Timeline::apply( OutputPool<T> *pool, size_t index )
+{
+  return apply( pool, index, Sequence<T>( (*pool)[index] ) );
+}
+
+template<typename T>
+MotionOptions<T> Timeline::apply( OutputPool<T> *pool, size_t index, const Sequence<T> &sequence )
+{
+  auto &motion_ref = createMotion<T>( pool->slot( index ), sequence );
+
+  return MotionOptions<T>( motion_ref, *this );
+}
+
+template<typename T>
+MotionOptions<T> Timeline::apply( OutputPool<T> *pool, size_t index, const typename Motion<T>::SharedSequenceRef &sequence )
+{
+  auto &motion_ref = createMotion<T>( pool->slot( index ), sequence );
+
+  return MotionOptions<T>( motion_ref, *this );
+}
+
+template<typename T>
+MotionOptions<T> Timeline::append( OutputPool<T> *pool, size_t index )
+{
+  auto motion = pool->inputPtr( index );
+  if( motion ) {
+    return MotionOptions<T>( *motion, *this );
+  }
+  return apply( pool, index );
+}
+
 template<typename T>
 MotionOptions<T> Timeline::applyRaw( T *output )
 { // Remove any existing motions that affect the same variable.
   // This is a raw pointer, so we don't know about any prior relationships.
   cancel( output );
 
-  auto motion = detail::make_unique<Motion<T>>( output );
+  auto &m = createMotion<T>( output, Sequence<T>( *output ) );
 
-  auto &m = *motion;
-  add( std::move( motion ) );
-
-  return MotionOptions<T>( m, m.getSequence(), *this );
+  return MotionOptions<T>( m, *this );
 }
 
 template<typename T>
 MotionOptions<T> Timeline::applyRaw( T *output, const Sequence<T> &sequence )
 { // Remove any existing motions that affect the same variable.
   cancel( output );
-  auto motion = detail::make_unique<Motion<T>>( output, sequence );
+  auto &m = createMotion<T>( output, sequence );
 
-  auto &m = *motion;
-  add( std::move( motion ) );
+  return MotionOptions<T>( m, *this );
+}
+
+template<typename T>
+MotionOptions<T> Timeline::applyRaw( T *output, const typename Motion<T>::SharedSequenceRef &sequence )
+{ // Remove any existing motions that affect the same variable.
+  cancel( output );
+  auto &m = createMotion<T>( output, sequence );
 
-  return MotionOptions<T>( m, m.getSequence(), *this );
+  return MotionOptions<T>( m, *this );
 }
 
 template<typename T>
@@ -267,17 +669,18 @@ MotionOptions<T> Timeline::appendRaw( T *output )
 {
   auto motion = find( output );
   if( motion ) {
-    return MotionOptions<T>( *motion, motion->getSequence(), *this );
+    return MotionOptions<T>( *motion, *this );
   }
-  return apply( output );
+  return applyRaw( output );
 }
 
 template<typename T>
 Motion<T>* Timeline::find( T *output ) const
 {
-  for( auto &m : _items ) {
-    if( m->getTarget() == output ) {
-      return dynamic_cast<Motion<T>*>( m.get() );
+  const auto key = detail::typeKey<Motion<T>>();
+  for( auto item = _targets.find( output ); item; item = item->_older_with_target ) {
+    if( item->getTypeKey() == key && ! item->cancelled() && item->getTarget() == output ) {
+      return static_cast<Motion<T>*>( item );
     }
   }
   return nullptr;
@@ -26,6 +26,10 @@
  */
 
 #include "TimelineItem.h"
+#include "Timeline.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
 
 using namespace choreograph;
 
@@ -55,6 +59,85 @@ bool Control::isInvalid() const
 ///
 ///
 
+TimelineItemHandle::TimelineItemHandle( detail::HandleTable *table, uint32_t index ):
+  _table( table ),
+  _index( index ),
+  _generation( table->generation( index ) )
+{
+  _table->retain();
+}
+
+TimelineItemHandle::TimelineItemHandle( const TimelineItemHandle &rhs ):
+  _table( rhs._table ),
+  _index( rhs._index ),
+  _generation( rhs._generation )
+{
+  if( _table ) {
+    _table->retain();
+  }
+}
+
+TimelineItemHandle::TimelineItemHandle( TimelineItemHandle &&rhs ):
+  _table( rhs._table ),
+  _index( rhs._index ),
+  _generation( rhs._generation )
+{
+  rhs._table = nullptr;
+}
+
+TimelineItemHandle& TimelineItemHandle::operator= ( const TimelineItemHandle &rhs )
+{
+  if( rhs._table ) {
+    rhs._table->retain();
+  }
+  if( _table ) {
+    _table->release();
+  }
+  _table = rhs._table;
+  _index = rhs._index;
+  _generation = rhs._generation;
+  return *this;
+}
+
+TimelineItemHandle& TimelineItemHandle::operator= ( TimelineItemHandle &&rhs )
+{
+  if( this != &rhs )
+  {
+    if( _table ) {
+      _table->release();
+    }
+    _table = rhs._table;
+    _index = rhs._index;
+    _generation = rhs._generation;
+    rhs._table = nullptr;
+  }
+  return *this;
+}
+
+TimelineItemHandle::~TimelineItemHandle()
+{
+  if( _table ) {
+    _table->release();
+  }
+}
+
+void TimelineItemHandle::cancel()
+{
+  if( auto target = item() ) {
+    target->cancel();
+  }
+}
+
+bool TimelineItemHandle::isValid() const
+{
+  auto target = item();
+  return target && ! target->cancelled();
+}
+
+///
+///
+///
+
 TimelineItem::~TimelineItem()
 {
   if( _control ) {
@@ -64,16 +147,17 @@ TimelineItem::~TimelineItem()
 
 void TimelineItem::step( Time dt )
 {
-  _time += dt * _speed;
+  beginStep( dt );
   if( ! cancelled() ) {
     // update properties
     update();
   }
-  _previous_time = _time;
+  finishStep();
 }
 
 void TimelineItem::jumpTo( Time time )
 {
+  wakeIfParked();
   _time = time;
   if( ! cancelled() ) {
     // update properties
@@ -82,6 +166,113 @@ void TimelineItem::jumpTo( Time time )
   _previous_time = _time;
 }
 
+void TimelineItem::targetChanged()
+{
+  if( _parent ) {
+    _parent->retarget( *this );
+  }
+}
+
+void TimelineItem::durationChanged()
+{
+  if( _parent ) {
+    _parent->childDurationChanged();
+  }
+}
+
+void TimelineItem::wake()
+{
+  _parent->unpark( *this );
+}
+
+Time TimelineItem::parkedTime() const
+{
+  return _time + (_parent->_park_clock - _parked_clock) * _speed;
+}
+
+Time TimelineItem::idleTime() const
+{
+  Time begin, end;
+  if( ! getIdleSpan( &begin, &end ) ) {
+    return 0;
+  }
+
+  // Throttled items are behind by the time they skipped.
+  const auto now = time() + _skipped_time * _speed;
+  const auto remaining = forward() ? end - now : now - begin;
+  if( remaining <= 0 ) {
+    return 0;
+  }
+  const auto speed = std::abs( _speed );
+  return (speed > 0) ? remaining / speed : std::numeric_limits<Time>::infinity();
+}
+
+void TimelineItem::parkAt( Time park_clock )
+{
+  _parked = true;
+  // Catch up on skipped time when woken.
+  _parked_clock = park_clock - _skipped_time;
+  _skipped_time = 0;
+  _deferred = false;
+}
+
+void TimelineItem::unparkAt( Time park_clock )
+{
+  _time += (park_clock - _parked_clock) * _speed;
+  _previous_time = _time;
+  _parked = false;
+}
+
+void TimelineItem::setUpdateInterval( Time interval )
+{
+  wakeIfParked();
+  _update_interval = interval;
+  // Start partway through the first interval, so items given the same interval update on different steps.
+  _update_countdown = _parent ? interval * _parent->nextUpdatePhase() : 0;
+}
+
+void TimelineItem::setPriority( int priority )
+{
+  _priority = priority;
+  if( _parent ) {
+    _parent->priorityChanged();
+  }
+}
+
+bool TimelineItem::takeThrottledUpdate( Time dt, Time *step )
+{
+  _skipped_time += dt;
+  _update_countdown -= std::abs( dt );
+  // Allow for rounding, so a 10Hz item updates on every sixth step at 60Hz.
+  // A deferred update is already due.
+  if( _update_countdown > _update_interval * 1.0e-6 && ! _deferred ) {
+    return false;
+  }
+
+  *step = _skipped_time;
+  _skipped_time = 0;
+  _deferred = false;
+  _update_countdown = std::max<Time>( _update_countdown + _update_interval, 0 );
+  return true;
+}
+
+bool TimelineItem::getIdleSpan( Time *begin, Time *end ) const
+{
+  if( ! idleUntilStart() || ! waitingToStart() ) {
+    return false;
+  }
+
+  if( forward() ) {
+    *begin = - std::numeric_limits<Time>::infinity();
+    *end = 0;
+  }
+  else {
+    *begin = getDuration();
+    *end = std::numeric_limits<Time>::infinity();
+  }
+  return true;
+}
+
 bool TimelineItem::isFinished() const
 {
   if( backward() ) {
@@ -115,7 +306,15 @@ Time TimelineItem::getTimeUntilFinish() const
 const std::shared_ptr<Control>& TimelineItem::getControl()
 {
   if( ! _control ) {
-    _control = std::make_shared<Control>( this );
+    _control = detail::make_pooled<Control>( this );
   }
   return _control;
+}
+
+TimelineItemHandle TimelineItem::getHandle()
+{
+  if( ! _parent ) {
+    return TimelineItemHandle();
+  }
+  return _parent->handleFor( *this );
 }
\ No newline at end of file
@@ -28,17 +28,28 @@
 #pragma once
 
 #include "TimeType.h"
+#include "detail/Pool.hpp"
+#include "detail/HandleTable.hpp"
+#include <vector>
 
 namespace choreograph
 {
 
 class TimelineItem;
+class Timeline;
+namespace detail
+{
+class MotionBucketBase;
+template<typename T> class MotionBucket;
+} // namespace detail
 using TimelineItemRef = std::shared_ptr<TimelineItem>;
 using TimelineItemUniqueRef = std::unique_ptr<TimelineItem>;
 
 ///
 /// Control struct for cancelling TimelineItems.
 /// Accessible through the CueOptions struct.
+/// Kept for compatibility and for items not on a Timeline.
+/// Prefer TimelineItemHandle, which doesn't allocate or count references atomically.
 ///
 class Control
 {
@@ -68,6 +79,53 @@ private:
   std::shared_ptr<Control>  _control;
 };
 
+///
+/// Generational handle to an item on a Timeline, for cancelling it or checking whether it is still there.
+/// Handles don't allocate or count references atomically, so they are cheap to keep per animation.
+/// A default-constructed handle, or one whose item left its Timeline, is invalid and cancel() does nothing.
+/// Safe to keep after the Timeline is destroyed. Use handles only on the thread that updates their Timeline.
+///
+class TimelineItemHandle
+{
+public:
+  TimelineItemHandle() = default;
+  TimelineItemHandle( detail::HandleTable *table, uint32_t index );
+  TimelineItemHandle( const TimelineItemHandle &rhs );
+  TimelineItemHandle( TimelineItemHandle &&rhs );
+  TimelineItemHandle& operator= ( const TimelineItemHandle &rhs );
+  TimelineItemHandle& operator= ( TimelineItemHandle &&rhs );
+  ~TimelineItemHandle();
+
+  /// Cancel the TimelineItem this refers to, if it is still on its Timeline.
+  void cancel();
+  /// Returns true if referring to a non-cancelled item.
+  bool isValid() const;
+
+  bool isInvalid() const { return ! isValid(); }
+private:
+  detail::HandleTable *_table = nullptr;
+  uint32_t            _index = 0;
+  uint32_t            _generation = 0;
+
+  TimelineItem* item() const { return _table ? _table->find( _index, _generation ) : nullptr; }
+};
+
+/// Handle that cancels its TimelineItem when it falls out of scope.
+class ScopedCancelHandle
+{
+public:
+  ScopedCancelHandle() = default;
+  explicit ScopedCancelHandle( const TimelineItemHandle &handle ): _handle( handle ) {}
+  ~ScopedCancelHandle() { _handle.cancel(); }
+  ScopedCancelHandle( const ScopedCancelHandle &rhs ) = delete;
+  ScopedCancelHandle( ScopedCancelHandle &&rhs ): _handle( std::move( rhs._handle ) ) {}
+  ScopedCancelHandle& operator= ( ScopedCancelHandle &&rhs ) { _handle.cancel(); _handle = std::move( rhs._handle ); return *this; }
+
+  const TimelineItemHandle& getHandle() const { return _handle; }
+private:
+  TimelineItemHandle  _handle;
+};
+
 ///
 /// TimelineItem: non-templated base for polymorphic Motions.
 /// Base class for anything that can go on a Timeline.
@@ -82,6 +140,16 @@ public:
 
   virtual ~TimelineItem();
 
+  /// TimelineItems are allocated from per-thread caches of small blocks,
+  /// so creating and removing items in a steady state doesn't touch the global heap.
+  static void* operator new( size_t size ) { return detail::allocateSmall( size ); }
+  static void operator delete( void *ptr, size_t size ) { detail::deallocateSmall( ptr, size ); }
+#if defined( __cpp_aligned_new )
+  /// Over-aligned items, like Motions of SIMD types, come from the global heap, which honors their alignment.
+  static void* operator new( size_t size, std::align_val_t alignment ) { return ::operator new( size, alignment ); }
+  static void operator delete( void *ptr, size_t size, std::align_val_t alignment ) { ::operator delete( ptr, size, alignment ); }
+#endif
+
   //=================================================
   // Common public interface.
   //=================================================
@@ -96,7 +164,7 @@ public:
 
   /// Set time of item without updating state. Ignores playback speed.
   /// Safe to use from callbacks.
-  void setTime( Time time ) { _time = _previous_time = time; customSetTime( time ); }
+  void setTime( Time time ) { wakeIfParked(); _time = _previous_time = time; _skipped_time = 0; _deferred = false; customSetTime( time ); }
 
   //=================================================
   // Virtual Interface.
@@ -112,20 +180,45 @@ public:
   /// Returns true iff motion is no longer valid. Deprecated in favor of cancelled().
   bool isInvalid() const { return _cancelled; }
 
+  /// Returns true if the item's update() can be split into evaluate() and dispatchCallbacks().
+  /// Timelines with a ParallelExecutor call evaluate() for such items from worker threads,
+  /// then call dispatchCallbacks() on the updating thread in item order.
+  virtual bool supportsParallelEvaluation() const { return false; }
+
+  /// Override to do the part of update() that only touches state owned by this item.
+  /// May be called concurrently with other items' evaluate().
+  virtual void evaluate() {}
+
+  /// Override to do the part of update() that calls user code. Always called on the updating thread after evaluate().
+  virtual void dispatchCallbacks() {}
+
   /// Returns target if TimelineItem has one.
   /// Used by Timeline when appending to Motions.
   /// May be removed in favor of an alternative identifying mechanism in the future.
   virtual const void* getTarget() const { return nullptr; }
 
+  /// Override to return true if update() does nothing new while the item waits to start.
+  /// Timeline parks such items while they wait instead of stepping them every frame. See waitingToStart().
+  virtual bool idleUntilStart() const { return false; }
+
+  /// Override to report a span of time() containing the current time over which update() does nothing new.
+  /// Returns false if the item is active. Timeline parks idle items until they play out of the span.
+  /// By default, items that are idleUntilStart() are idle while they wait to start.
+  virtual bool getIdleSpan( Time *begin, Time *end ) const;
+
+  /// Returns a key identifying the item's concrete type, or nullptr if the type didn't set one.
+  /// Lets Timeline recover a Motion<T> from a TimelineItem without dynamic_cast.
+  const void* getTypeKey() const { return _type_key; }
+
   //=================================================
   // Time manipulation and querying.
   //=================================================
 
-  /// Returns current animation time in seconds.
-  Time time() const { return _time - _start_time; }
+  /// Returns current animation time in seconds. Includes time that passed while parked.
+  Time time() const { return (_parked ? parkedTime() : _time) - _start_time; }
 
-  /// Returns previous step's animation time in seconds.
-  Time previousTime() const { return _previous_time - _start_time; }
+  /// Returns previous step's animation time in seconds. Equal to time() while parked.
+  Time previousTime() const { return (_parked ? parkedTime() : _previous_time) - _start_time; }
 
   /// Returns the delta time this animation step in seconds.
   Time deltaTime() const { return _time - _previous_time; }
@@ -140,7 +233,7 @@ public:
   bool  isFinished() const;
 
   /// Set playback speed of motion. Use negative numbers to play in reverse.
-  void  setPlaybackSpeed( Time s ) { _speed = s; customSetPlaybackSpeed( s ); }
+  void  setPlaybackSpeed( Time s ) { wakeIfParked(); _speed = s; customSetPlaybackSpeed( s ); }
 
   /// Returns the current playback speed of motion.
   Time getPlaybackSpeed() const { return _speed; }
@@ -154,8 +247,20 @@ public:
   /// Returns the amount of time at current playback speed before finish.
   Time getTimeUntilFinish() const;
 
+  /// Set the minimum time between updates when stepped by a Timeline. Zero, the default, updates every step.
+  /// Between updates, the Timeline accumulates the skipped time and steps the item by all of it at once,
+  /// so the item keeps time but its values and callbacks move in coarser increments.
+  /// Items with the same interval are spread across steps so they don't all update on the same one.
+  void setUpdateInterval( Time interval );
+  Time getUpdateInterval() const { return _update_interval; }
+
+  /// Set the order in which the parent Timeline steps this item. Higher priorities step first. Default is zero.
+  /// When a budgeted step runs out of time, the lowest-priority items are the ones deferred.
+  void setPriority( int priority );
+  int  getPriority() const { return _priority; }
+
   /// Set the start time of this motion. Use to delay entire motion.
-  void setStartTime( Time t ) { _start_time = t; }
+  void setStartTime( Time t ) { wakeIfParked(); _start_time = t; durationChanged(); }
   Time getStartTime() const { return _start_time; }
 
   /// Set whether the Motion should be removed from parent Timeline on finish.
@@ -164,17 +269,87 @@ public:
   /// Returns true if the Motion should be removed from parent Timeline on finish.
   bool getRemoveOnFinish() const { return _remove_on_finish; }
 
+  /// Returns true if the item hasn't reached its start yet. Accounts for reversed playback.
+  /// Playing backward, an item starts at the end of its duration.
+  bool waitingToStart() const { return forward() ? time() < 0.0f : time() > getDuration(); }
+
   bool cancelled() const { return _cancelled; }
-  void cancel() { _cancelled = true; }
+  void cancel() { wakeIfParked(); _cancelled = true; }
+
+  /// Returns true while the parent Timeline holds this item aside instead of stepping it.
+  bool isParked() const { return _parked; }
 
   /// Returns a shared_ptr to a control that allows you to cancel the Cue.
   const std::shared_ptr<Control>& getControl();
+
+  /// Returns a handle that allows you to cancel the item. Invalid if the item isn't on a Timeline.
+  TimelineItemHandle getHandle();
 protected:
+  /// Advances time by \a dt at playback speed without calling update().
+  /// Lets containers that know an item's concrete type call its update() directly.
+  /// Must be paired with a call to finishStep().
+  void beginStep( Time dt ) { _time += dt * _speed; }
+  /// Records the current time as the previous time. Ends a step started with beginStep().
+  void finishStep() { _previous_time = _time; }
+  /// Adds \a dt to the time skipped since the last update. Returns true if the item is due for an update,
+  /// with the time to step by in \a step. See setUpdateInterval().
+  bool takeUpdate( Time dt, Time *step )
+  {
+    if( _update_interval > 0 ) {
+      return takeThrottledUpdate( dt, step );
+    }
+    *step = dt + _skipped_time;
+    _skipped_time = 0;
+    _deferred = false;
+    return true;
+  }
+  /// Like takeUpdate(), but holds a due update for the next step, which will include the time skipped now.
+  /// Returns true if an update was due.
+  bool deferUpdate( Time dt )
+  {
+    Time step;
+    if( ! takeUpdate( dt, &step ) ) {
+      return false;
+    }
+    _skipped_time = step;
+    _deferred = true;
+    return true;
+  }
+  /// Returns true if the last update due was deferred.
+  bool updateDeferred() const { return _deferred; }
+
   /// Override to handle additional time setting as needed.
   /// Used by MotionGroup to propagate setTime calls to timeline.
   virtual void customSetTime( Time time ) {}
   virtual void customSetPlaybackSpeed( Time time ) {}
+
+  /// Set by subclasses that Timeline needs to find by type. See detail::typeKey().
+  void setTypeKey( const void *key ) { _type_key = key; }
+  /// Call when the value returned by getTarget() changes, so the parent Timeline can update its target index.
+  void targetChanged();
+  /// Call when the value returned by getDuration() may have changed, so the parent Timeline can update its cached duration.
+  void durationChanged();
+  /// Call when stepping changes the value at \a target. Recorded if the parent Timeline tracks changes.
+  void targetValueChanged( const void *target ) { if( _change_list ) { _change_list->push_back( target ); } }
+  /// Returns true if the parent Timeline records changed targets. Lets items that write many targets skip looking for changes.
+  bool tracksChanges() const { return _change_list != nullptr; }
+  /// Returns true if the parent Timeline asks items to defer work that readers can do on demand. See Timeline::setLazyEvaluation().
+  bool evaluatesLazily() const { return _lazy; }
+  /// Returns a parked item to its parent Timeline's stepped items. Call before changing anything getIdleSpan() depends on.
+  void wakeIfParked() { if( _parked ) { wake(); } }
+
+  /// Returns how long the item will stay idle at its current speed while its parent steps forward, or zero if it is active. See getIdleSpan().
+  Time idleTime() const;
+  /// Marks the item parked as of \a park_clock, its parent Timeline's park clock. Time skipped by throttling is caught up on waking.
+  void parkAt( Time park_clock );
+  /// Brings the item's time up to \a park_clock and marks it no longer parked.
+  void unparkAt( Time park_clock );
 private:
+  void wake();
+  /// Returns the time a parked item would have reached had it been stepped.
+  Time parkedTime() const;
+  bool takeThrottledUpdate( Time dt, Time *step );
+
   /// True if this motion should be removed from Timeline on finish.
   bool       _remove_on_finish = true;
   /// Playback speed. Set to negative to go in reverse.
@@ -189,6 +364,41 @@ private:
   /// True iff this item was cancelled.
   bool       _cancelled = false;
   std::shared_ptr<Control>  _control;
+  const void *_type_key = nullptr;
+
+  /// Timeline this item was added to, if any.
+  Timeline          *_parent = nullptr;
+  /// True while the parent Timeline holds this item aside instead of stepping it.
+  bool              _parked = false;
+  /// Parent Timeline's park clock when this item was parked.
+  Time              _parked_clock = 0;
+  /// Parent Timeline's list of changed targets, if it tracks changes.
+  std::vector<const void*>  *_change_list = nullptr;
+  /// True if the parent Timeline evaluates lazily.
+  bool              _lazy = false;
+  /// Minimum time between updates. Zero to update every step.
+  Time              _update_interval = 0;
+  /// Parent time accumulated since the last update.
+  Time              _skipped_time = 0;
+  /// Time left until the next update.
+  Time              _update_countdown = 0;
+  /// Order in which the parent Timeline steps this item. Higher first.
+  int               _priority = 0;
+  /// True if a budgeted step held back an update that was due.
+  bool              _deferred = false;
+  /// Slot in the parent Timeline's handle table, plus one. Zero if no handle was requested.
+  uint32_t          _handle_slot = 0;
+  /// Target this item is indexed under in its parent Timeline.
+  const void        *_indexed_target = nullptr;
+  /// Next item indexed under the same target, added before this one.
+  TimelineItem      *_older_with_target = nullptr;
+  /// Bucket that evaluates this item while it plays within one Phrase, if its parent Timeline stores Motions in buckets.
+  detail::MotionBucketBase  *_bucket = nullptr;
+
+  /// Timeline steps items in phases when updating in parallel.
+  friend class Timeline;
+  /// Buckets evaluate items from their time state while they are parked.
+  template<typename T> friend class detail::MotionBucket;
 };
 
 using TimelineItemControlRef = std::shared_ptr<Control>;
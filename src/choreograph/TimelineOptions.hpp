@@ -28,6 +28,7 @@
 #pragma once
 
 #include "Motion.hpp"
+#include "StaggeredMotion.hpp"
 #include "phrase/Ramp.hpp"
 #include "Cue.h"
 
@@ -64,6 +65,16 @@ public:
   /// For Motions, this is akin to adding a hold at the beginning of the Sequence.
   Derived& setStartTime( Time t ) { _item.setStartTime( t ); return self(); }
 
+  /// Set the minimum time between updates of the item. Zero, the default, updates every step.
+  /// Use for background or distant animations that don't need to move every frame.
+  Derived& updateInterval( Time seconds ) { _item.setUpdateInterval( seconds ); return self(); }
+
+  /// Set how many times per second the item is updated, like 30 or 10. Zero updates every step.
+  Derived& updateRate( Time hz ) { _item.setUpdateInterval( hz > 0 ? 1 / hz : 0 ); return self(); }
+
+  /// Set the order in which the Timeline steps the item. Higher priorities step first and are the last deferred by a budgeted step.
+  Derived& priority( int priority ) { _item.setPriority( priority ); return self(); }
+
 	TimelineItem& getItem() { return _item; }
 
   /// Returns a shared_ptr to the control object for the Item. Allows you to cancel the Item later.
@@ -73,6 +84,12 @@ public:
   /// You should store a ScopedCueRef in any class that captures [this] in a cued lambda.
   ScopedCancelRef         getScopedControl() { return std::make_shared<ScopedCancel>( _item.getControl() ); }
 
+  /// Returns a handle for cancelling the Item later. Unlike getControl(), doesn't allocate.
+  TimelineItemHandle      getHandle() { return _item.getHandle(); }
+
+  /// Returns a handle that cancels the Item when it falls out of scope. Unlike getScopedControl(), doesn't allocate.
+  ScopedCancelHandle      getScopedHandle() { return ScopedCancelHandle( _item.getHandle() ); }
+
 private:
   TimelineItem &_item;
   Derived& self() { return static_cast<Derived&>( *this ); }
@@ -103,10 +120,9 @@ public:
   using SelfT = MotionOptions<T>;
   using MotionCallback = typename Motion<T>::Callback;
 
-  MotionOptions( Motion<T> &motion, Sequence<T> &sequence, const Timeline &timeline ):
+  MotionOptions( Motion<T> &motion, const Timeline &timeline ):
   TimelineOptionsBase<MotionOptions<T>>( motion ),
   _motion( motion ),
-  _sequence( sequence ),
   _timeline( timeline )
   {}
 
@@ -126,7 +142,7 @@ public:
   /// Set a function to be called when the current inflection point is crossed.
   /// An inflection occcurs when the Sequence moves from one Phrase to the next.
   /// You must add a phrase after this for the inflection to occur.
-  SelfT& onInflection( const MotionCallback &fn ) { return onInflection( _sequence.getPhraseCount(), fn ); }
+  SelfT& onInflection( const MotionCallback &fn ) { return onInflection( sequence().getPhraseCount(), fn ); }
   /// Adds an inflection callback when the specified phrase index is crossed.
   SelfT& onInflection( size_t point, const MotionCallback &fn ) { _motion.addInflectionCallback( point, fn ); return *this; }
 
@@ -143,41 +159,76 @@ public:
   //=================================================
 
   /// Set the current value of the Sequence. Acts as an instantaneous hold.
-  SelfT& set( const T &value ) { _sequence.set( value ); return *this; }
+  SelfT& set( const T &value ) { getSequence().set( value ); return *this; }
 
   /// Construct and append a Phrase to the Sequence.
   template<template <typename> class PhraseT, typename... Args>
-  SelfT& then( const T &value, Time duration, Args&&... args ) { _sequence.template then<PhraseT>( value, duration, std::forward<Args>(args)... ); return *this; }
+  SelfT& then( const T &value, Time duration, Args&&... args ) { getSequence().template then<PhraseT>( value, duration, std::forward<Args>(args)... ); return *this; }
 
   /// Append a phrase to the Sequence.
-  SelfT& then( const PhraseRef<T> &phrase ) { _sequence.then( phrase ); return *this; }
+  SelfT& then( const PhraseRef<T> &phrase ) { getSequence().then( phrase ); return *this; }
 
   /// Append a sequence to the Sequence.
-  SelfT& then( const Sequence<T> &sequence ) { _sequence.then( sequence ); return *this; }
+  SelfT& then( const Sequence<T> &sequence ) { getSequence().then( sequence ); return *this; }
 
   //=================================================
   // Extra Sugar.
   //=================================================
 
   /// Append a Hold to the end of the Sequence. Assumes you want to hold using the Sequence's current end value.
-  SelfT& hold( Time duration ) { _sequence.template then<Hold>( _sequence.getEndValue(), duration ); return *this; }
+  SelfT& hold( Time duration ) { getSequence().template then<Hold>( sequence().getEndValue(), duration ); return *this; }
 
-	SelfT& holdUntil( Time time ) { _sequence.template then<Hold>( _sequence.getEndValue(), std::max<Time>( time - _sequence.getDuration(), 0 ) ); return *this; }
+	SelfT& holdUntil( Time time ) { getSequence().template then<Hold>( sequence().getEndValue(), std::max<Time>( time - sequence().getDuration(), 0 ) ); return *this; }
 
   template<typename... Args>
-  SelfT& rampTo( const T &value, Time duration, Args&&... args ) { _sequence.template then<RampTo>( value, duration, std::forward<Args>(args)... ); return *this; }
+  SelfT& rampTo( const T &value, Time duration, Args&&... args ) { getSequence().template then<RampTo>( value, duration, std::forward<Args>(args)... ); return *this; }
+
+  /// Append a StaticRampTo to \a value. Ease and lerp function types are deduced, see Sequence::rampTo().
+  template<typename... Args>
+  SelfT& staticRampTo( const T &value, Time duration, Args&&... args ) { getSequence().rampTo( value, duration, std::forward<Args>(args)... ); return *this; }
 
   //=================================================
   // Accessors to Motion and Sequence.
   //=================================================
 
-  Sequence<T>& getSequence() { return _sequence; }
+  /// Returns the Motion's Sequence for editing. Copies a shared Sequence first, see Motion::getSequence().
+  Sequence<T>& getSequence() { return _motion.getSequence(); }
   Motion<T>&   getMotion() { return _motion; }
 
 private:
   Motion<T>       &_motion;
-  Sequence<T>     &_sequence;
   const Timeline  &_timeline;
+
+  /// Returns the Motion's Sequence for reading, without copying a shared Sequence.
+  const Sequence<T>& sequence() const { return static_cast<const Motion<T>&>( _motion ).getSequence(); }
+};
+
+///
+/// StaggeredMotionOptions provide a temporary facade for manipulating a timeline StaggeredMotion.
+/// Do not store the StaggeredMotionOptions object, as it contains a non-owning reference.
+///
+template<typename T>
+class StaggeredMotionOptions : public TimelineOptionsBase<StaggeredMotionOptions<T>>
+{
+public:
+  using SelfT = StaggeredMotionOptions<T>;
+  using Callback = typename StaggeredMotion<T>::Callback;
+
+  StaggeredMotionOptions( StaggeredMotion<T> &motion ):
+  TimelineOptionsBase<StaggeredMotionOptions<T>>( motion ),
+  _motion( motion )
+  {}
+
+  /// Set function to be called after all targets update.
+  SelfT& updateFn( const Callback &fn ) { _motion.setUpdateFn( fn ); return *this; }
+
+  /// Set function to be called when the last target finishes.
+  SelfT& finishFn( const Callback &fn ) { _motion.setFinishFn( fn ); return *this; }
+
+  StaggeredMotion<T>& getMotion() { return _motion; }
+
+private:
+  StaggeredMotion<T> &_motion;
 };
 
 } // namespace choreograph
@@ -0,0 +1,197 @@
+/*
+ * Copyright (c) 2014 David Wicks, sansumbrella.com
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#if defined( __SSE2__ ) || defined( _M_X64 ) || (defined( _M_IX86_FP ) && _M_IX86_FP >= 2)
+  #define CHOREOGRAPH_SSE2 1
+  #include <emmintrin.h>
+#endif
+
+///
+/// \file
+/// Four-wide float math used by the batch easing kernels.
+/// Uses SSE2 where available and plain arrays elsewhere.
+/// Both versions run the same approximations, so results match across platforms.
+///
+
+namespace choreograph
+{
+namespace detail
+{
+
+#if defined( CHOREOGRAPH_SSE2 )
+
+struct Float4
+{
+  Float4( float f ): v( _mm_set1_ps( f ) ) {}
+  Float4( __m128 m ): v( m ) {}
+  __m128 v;
+};
+
+struct Mask4
+{
+  __m128 v;
+};
+
+inline Float4 load4( const float *p ) { return _mm_loadu_ps( p ); }
+inline void   store4( float *p, Float4 a ) { _mm_storeu_ps( p, a.v ); }
+
+inline Float4 operator+ ( Float4 a, Float4 b ) { return _mm_add_ps( a.v, b.v ); }
+inline Float4 operator- ( Float4 a, Float4 b ) { return _mm_sub_ps( a.v, b.v ); }
+inline Float4 operator* ( Float4 a, Float4 b ) { return _mm_mul_ps( a.v, b.v ); }
+inline Float4 operator/ ( Float4 a, Float4 b ) { return _mm_div_ps( a.v, b.v ); }
+inline Float4 operator- ( Float4 a ) { return _mm_xor_ps( a.v, _mm_set1_ps( -0.0f ) ); }
+
+inline Mask4 operator< ( Float4 a, Float4 b ) { return { _mm_cmplt_ps( a.v, b.v ) }; }
+inline Mask4 operator> ( Float4 a, Float4 b ) { return { _mm_cmpgt_ps( a.v, b.v ) }; }
+inline Mask4 operator== ( Float4 a, Float4 b ) { return { _mm_cmpeq_ps( a.v, b.v ) }; }
+inline Mask4 operator| ( Mask4 a, Mask4 b ) { return { _mm_or_ps( a.v, b.v ) }; }
+
+/// Returns \a a where \a mask is set and \a b elsewhere.
+inline Float4 select( Mask4 mask, Float4 a, Float4 b ) { return _mm_or_ps( _mm_and_ps( mask.v, a.v ), _mm_andnot_ps( mask.v, b.v ) ); }
+
+inline Float4 sqrt4( Float4 a ) { return _mm_sqrt_ps( a.v ); }
+inline Float4 min4( Float4 a, Float4 b ) { return _mm_min_ps( a.v, b.v ); }
+inline Float4 max4( Float4 a, Float4 b ) { return _mm_max_ps( a.v, b.v ); }
+
+/// Rounds to the nearest integer, ties to even.
+inline Float4 round4( Float4 a ) { return _mm_cvtepi32_ps( _mm_cvtps_epi32( a.v ) ); }
+
+/// Returns 2^n for integral \a n in [-126, 127].
+inline Float4 pow2i4( Float4 n ) { return _mm_castsi128_ps( _mm_slli_epi32( _mm_add_epi32( _mm_cvtps_epi32( n.v ), _mm_set1_epi32( 127 ) ), 23 ) ); }
+
+/// Negates \a a where integral \a n is odd.
+inline Float4 negateIfOdd4( Float4 a, Float4 n ) { return _mm_xor_ps( a.v, _mm_castsi128_ps( _mm_slli_epi32( _mm_cvtps_epi32( n.v ), 31 ) ) ); }
+
+#else
+
+struct Float4
+{
+  Float4( float f ): v{ f, f, f, f } {}
+  Float4( float a, float b, float c, float d ): v{ a, b, c, d } {}
+  float v[4];
+};
+
+struct Mask4
+{
+  bool v[4];
+};
+
+inline Float4 load4( const float *p ) { return Float4( p[0], p[1], p[2], p[3] ); }
+inline void   store4( float *p, Float4 a ) { std::memcpy( p, a.v, sizeof( a.v ) ); }
+
+template<typename Fn>
+inline Float4 map4( Float4 a, Float4 b, Fn fn ) { return Float4( fn( a.v[0], b.v[0] ), fn( a.v[1], b.v[1] ), fn( a.v[2], b.v[2] ), fn( a.v[3], b.v[3] ) ); }
+
+template<typename Fn>
+inline Mask4 compare4( Float4 a, Float4 b, Fn fn ) { return { { fn( a.v[0], b.v[0] ), fn( a.v[1], b.v[1] ), fn( a.v[2], b.v[2] ), fn( a.v[3], b.v[3] ) } }; }
+
+inline Float4 operator+ ( Float4 a, Float4 b ) { return map4( a, b, [] (float x, float y) { return x + y; } ); }
+inline Float4 operator- ( Float4 a, Float4 b ) { return map4( a, b, [] (float x, float y) { return x - y; } ); }
+inline Float4 operator* ( Float4 a, Float4 b ) { return map4( a, b, [] (float x, float y) { return x * y; } ); }
+inline Float4 operator/ ( Float4 a, Float4 b ) { return map4( a, b, [] (float x, float y) { return x / y; } ); }
+inline Float4 operator- ( Float4 a ) { return Float4( -a.v[0], -a.v[1], -a.v[2], -a.v[3] ); }
+
+inline Mask4 operator< ( Float4 a, Float4 b ) { return compare4( a, b, [] (float x, float y) { return x < y; } ); }
+inline Mask4 operator> ( Float4 a, Float4 b ) { return compare4( a, b, [] (float x, float y) { return x > y; } ); }
+inline Mask4 operator== ( Float4 a, Float4 b ) { return compare4( a, b, [] (float x, float y) { return x == y; } ); }
+inline Mask4 operator| ( Mask4 a, Mask4 b ) { return { { a.v[0] || b.v[0], a.v[1] || b.v[1], a.v[2] || b.v[2], a.v[3] || b.v[3] } }; }
+
+/// Returns \a a where \a mask is set and \a b elsewhere.
+inline Float4 select( Mask4 mask, Float4 a, Float4 b ) { return Float4( mask.v[0] ? a.v[0] : b.v[0], mask.v[1] ? a.v[1] : b.v[1], mask.v[2] ? a.v[2] : b.v[2], mask.v[3] ? a.v[3] : b.v[3] ); }
+
+inline Float4 sqrt4( Float4 a ) { return Float4( std::sqrt( a.v[0] ), std::sqrt( a.v[1] ), std::sqrt( a.v[2] ), std::sqrt( a.v[3] ) ); }
+inline Float4 min4( Float4 a, Float4 b ) { return map4( a, b, [] (float x, float y) { return x < y ? x : y; } ); }
+inline Float4 max4( Float4 a, Float4 b ) { return map4( a, b, [] (float x, float y) { return x > y ? x : y; } ); }
+
+/// Rounds to the nearest integer, ties to even.
+inline Float4 round4( Float4 a ) { return Float4( std::nearbyint( a.v[0] ), std::nearbyint( a.v[1] ), std::nearbyint( a.v[2] ), std::nearbyint( a.v[3] ) ); }
+
+/// Returns 2^n for integral \a n in [-126, 127].
+inline Float4 pow2i4( Float4 n ) { return Float4( std::ldexp( 1.0f, (int)n.v[0] ), std::ldexp( 1.0f, (int)n.v[1] ), std::ldexp( 1.0f, (int)n.v[2] ), std::ldexp( 1.0f, (int)n.v[3] ) ); }
+
+/// Negates \a a where integral \a n is odd.
+inline Float4 negateIfOdd4( Float4 a, Float4 n ) { return Float4( ((int)n.v[0] & 1) ? -a.v[0] : a.v[0], ((int)n.v[1] & 1) ? -a.v[1] : a.v[1], ((int)n.v[2] & 1) ? -a.v[2] : a.v[2], ((int)n.v[3] & 1) ? -a.v[3] : a.v[3] ); }
+
+#endif
+
+//=================================================
+// Approximations shared by both versions.
+// Accurate to about 1e-6 over the ranges easing uses.
+//=================================================
+
+/// Returns 2^x.
+inline Float4 exp2Approx( Float4 x )
+{
+  x = min4( max4( x, -126.0f ), 127.0f );
+  const auto n = round4( x );
+  const auto f = (x - n) * 0.693147180559945f;
+  // Taylor series of e^f for |f| <= ln(2) / 2.
+  const auto p = 1.0f + f * (1.0f + f * (0.5f + f * (1.0f / 6.0f + f * (1.0f / 24.0f + f * (1.0f / 120.0f + f * (1.0f / 720.0f))))));
+  return p * pow2i4( n );
+}
+
+/// Returns sin( x ).
+inline Float4 sinApprox( Float4 x )
+{
+  // Reduce to r in [-pi/2, pi/2] with x = r + k * pi.
+  const auto k = round4( x * 0.318309886183791f );
+  const auto r = (x - k * 3.140625f) - k * 9.67653589793e-4f;
+  const auto r2 = r * r;
+  const auto s = r + r * r2 * (-1.0f / 6.0f + r2 * (1.0f / 120.0f + r2 * (-1.0f / 5040.0f + r2 * (1.0f / 362880.0f + r2 * (-1.0f / 39916800.0f)))));
+  return negateIfOdd4( s, k );
+}
+
+/// Returns cos( x ).
+inline Float4 cosApprox( Float4 x )
+{
+  return sinApprox( x + 1.57079632679490f );
+}
+
+/// Returns atan( x ).
+inline Float4 atanApprox( Float4 x )
+{
+  const auto negative = x < 0.0f;
+  auto a = select( negative, -x, x );
+  // Reduce to |a| <= tan(pi/8), after Cephes' atanf.
+  const auto large = a > 2.414213562373095f;
+  const auto medium = a > 0.414213562373095f;
+  const auto offset = select( large, 1.57079632679490f, select( medium, 0.785398163397448f, 0.0f ) );
+  a = select( large, -1.0f / a, select( medium, (a - 1.0f) / (a + 1.0f), a ) );
+  const auto z = a * a;
+  const auto p = (((8.05374449538e-2f * z - 1.38776856032e-1f) * z + 1.99777106478e-1f) * z - 3.33329491539e-1f) * z * a + a;
+  const auto y = offset + p;
+  return select( negative, -y, y );
+}
+
+} // namespace detail
+} // namespace choreograph
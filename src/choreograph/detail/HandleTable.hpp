@@ -0,0 +1,128 @@
+/*
+ * Copyright (c) 2014 David Wicks, sansumbrella.com
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace choreograph
+{
+
+class TimelineItem;
+
+namespace detail
+{
+
+///
+/// Slot map from generational handles to the TimelineItems of one Timeline.
+/// A slot's generation changes when its item leaves the Timeline, so stale handles find nothing.
+/// Reference counted without atomics by the owning Timeline and by handles; not thread-safe.
+/// Outlives its Timeline if handles remain, with every slot emptied.
+///
+class HandleTable
+{
+public:
+  HandleTable( const HandleTable &rhs ) = delete;
+  HandleTable& operator= ( const HandleTable &rhs ) = delete;
+
+  /// Creates a table referenced once, by its owner.
+  static HandleTable* create() { return new HandleTable(); }
+
+  void retain() { _references += 1; }
+  void release()
+  {
+    _references -= 1;
+    if( _references == 0 ) {
+      delete this;
+    }
+  }
+
+  /// Stores \a item in a free slot. Returns the slot index.
+  uint32_t insert( TimelineItem *item )
+  {
+    uint32_t index;
+    if( _free_head != NoSlot ) {
+      index = _free_head;
+      _free_head = _slots[index].next_free;
+    }
+    else {
+      index = static_cast<uint32_t>( _slots.size() );
+      _slots.emplace_back();
+    }
+    _slots[index].item = item;
+    return index;
+  }
+
+  /// Empties slot \a index and advances its generation, invalidating handles to it.
+  void erase( uint32_t index )
+  {
+    auto &slot = _slots[index];
+    slot.item = nullptr;
+    slot.generation += 1;
+    slot.next_free = _free_head;
+    _free_head = index;
+  }
+
+  /// Empties every slot. Called when the owning Timeline is destroyed.
+  void eraseAll()
+  {
+    for( uint32_t i = 0; i < _slots.size(); i += 1 ) {
+      if( _slots[i].item ) {
+        erase( i );
+      }
+    }
+  }
+
+  uint32_t generation( uint32_t index ) const { return _slots[index].generation; }
+
+  /// Returns the item in slot \a index if the slot is still at \a generation, otherwise nullptr.
+  TimelineItem* find( uint32_t index, uint32_t generation ) const
+  {
+    const auto &slot = _slots[index];
+    return (slot.generation == generation) ? slot.item : nullptr;
+  }
+
+private:
+  HandleTable() = default;
+
+  static const uint32_t NoSlot = 0xffffffff;
+
+  struct Slot
+  {
+    TimelineItem  *item = nullptr;
+    uint32_t      generation = 0;
+    uint32_t      next_free = NoSlot;
+  };
+
+  std::vector<Slot> _slots;
+  uint32_t          _free_head = NoSlot;
+  size_t            _references = 1;
+};
+
+} // namespace detail
+} // namespace choreograph
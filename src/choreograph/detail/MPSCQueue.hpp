@@ -0,0 +1,143 @@
+/*
+ * Copyright (c) 2014 David Wicks, sansumbrella.com
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace choreograph
+{
+namespace detail
+{
+
+///
+/// Bounded lock-free queue for many producer threads and one consumer thread.
+/// Each cell carries a sequence number telling producers and the consumer whose turn it is,
+/// so pushes never wait on each other and a full queue rejects pushes instead of blocking.
+///
+template<typename T>
+class MPSCQueue
+{
+public:
+  /// Creates a queue holding up to \a capacity values, rounded up to a power of two.
+  explicit MPSCQueue( size_t capacity )
+  {
+    size_t size = 2;
+    while( size < capacity ) {
+      size *= 2;
+    }
+    _mask = size - 1;
+    _cells.reset( new Cell[size] );
+    for( size_t i = 0; i < size; i += 1 ) {
+      _cells[i].sequence.store( i, std::memory_order_relaxed );
+    }
+  }
+
+  MPSCQueue( const MPSCQueue &rhs ) = delete;
+  MPSCQueue& operator= ( const MPSCQueue &rhs ) = delete;
+
+  /// Adds \a value to the queue. Safe to call from any thread.
+  /// Returns false and counts a drop if the queue is full.
+  bool push( T &&value )
+  {
+    auto position = _tail.load( std::memory_order_relaxed );
+    while( true )
+    {
+      auto &cell = _cells[position & _mask];
+      const auto sequence = cell.sequence.load( std::memory_order_acquire );
+      const auto difference = static_cast<intptr_t>( sequence ) - static_cast<intptr_t>( position );
+      if( difference == 0 ) {
+        if( _tail.compare_exchange_weak( position, position + 1, std::memory_order_relaxed ) ) {
+          cell.value = std::move( value );
+          cell.sequence.store( position + 1, std::memory_order_release );
+          return true;
+        }
+      }
+      else if( difference < 0 ) {
+        _dropped.fetch_add( 1, std::memory_order_relaxed );
+        return false;
+      }
+      else {
+        position = _tail.load( std::memory_order_relaxed );
+      }
+    }
+  }
+
+  /// Moves the oldest value into \a value. Call only from the consumer thread.
+  /// Returns false if the queue is empty or the oldest push is still being written.
+  bool pop( T &value )
+  {
+    const auto position = _head.load( std::memory_order_relaxed );
+    auto &cell = _cells[position & _mask];
+    const auto sequence = cell.sequence.load( std::memory_order_acquire );
+    if( static_cast<intptr_t>( sequence ) - static_cast<intptr_t>( position + 1 ) < 0 ) {
+      return false;
+    }
+
+    value = std::move( cell.value );
+    cell.value = T();
+    cell.sequence.store( position + _mask + 1, std::memory_order_release );
+    _head.store( position + 1, std::memory_order_relaxed );
+    return true;
+  }
+
+  /// Returns the number of values pushed and not yet popped. Approximate while other threads push.
+  size_t size() const
+  {
+    const auto head = _head.load( std::memory_order_relaxed );
+    const auto tail = _tail.load( std::memory_order_relaxed );
+    return (tail > head) ? tail - head : 0;
+  }
+
+  size_t capacity() const { return _mask + 1; }
+
+  /// Returns the number of pushes rejected because the queue was full.
+  size_t dropped() const { return _dropped.load( std::memory_order_relaxed ); }
+
+private:
+  struct Cell
+  {
+    std::atomic<size_t> sequence;
+    T                   value;
+  };
+
+  std::unique_ptr<Cell[]> _cells;
+  size_t                  _mask = 0;
+  // Padding keeps the producers' and consumer's counters on separate cache lines.
+  char                    _pad_0[64];
+  std::atomic<size_t>     _tail{ 0 };
+  char                    _pad_1[64];
+  std::atomic<size_t>     _head{ 0 };
+  char                    _pad_2[64];
+  std::atomic<size_t>     _dropped{ 0 };
+};
+
+} // namespace detail
+} // namespace choreograph
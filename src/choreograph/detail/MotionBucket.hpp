@@ -0,0 +1,341 @@
+/*
+ * Copyright (c) 2014 David Wicks, sansumbrella.com
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include "choreograph/Motion.hpp"
+#include "choreograph/ThreadPool.h"
+#include <algorithm>
+#include <functional>
+#include <vector>
+
+namespace choreograph
+{
+namespace detail
+{
+
+///
+/// Non-templated interface to a MotionBucket.
+/// Lets Timeline keep buckets of different value types in one collection.
+///
+class MotionBucketBase
+{
+public:
+  explicit MotionBucketBase( const void *type_key ):
+    _type_key( type_key )
+  {}
+
+  virtual ~MotionBucketBase() = default;
+
+  /// Takes \a item, a Motion of the bucket's value type, if the bucket can evaluate it until it plays out of its current Phrase.
+  /// Parks the Motion as of \a park_clock, its Timeline's park clock. Returns false and leaves \a item alone otherwise.
+  virtual bool admit( TimelineItemUniqueRef &item, Time park_clock ) = 0;
+
+  /// Writes the value of every Motion at the time \a park_clock implies, spread across \a executor's threads if there is one.
+  /// Changed targets are appended to \a changes, if not null. Lazily evaluated Outputs are marked stale instead.
+  /// Motions that played out of their Phrase are caught up to the start of the step, \a park_clock - \a dt,
+  /// and moved to \a woken, so stepping them by \a dt finishes the step. Returns the number of Motions evaluated.
+  virtual size_t step( Time park_clock, Time dt, const ParallelExecutor &executor, bool lazy, std::vector<const void*> *changes, std::vector<TimelineItemUniqueRef> &woken ) = 0;
+
+  /// Moves Motions woken since they were admitted, as by setTime() or cancel(), to \a destination.
+  virtual void releaseUnparked( std::vector<TimelineItemUniqueRef> &destination ) = 0;
+
+  /// Calls \a fn with every Motion in the bucket.
+  virtual void forEach( const std::function<void (TimelineItem &)> &fn ) = 0;
+
+  /// Destroys every Motion in the bucket.
+  virtual void clear() = 0;
+
+  /// Returns the latest end time of any Motion in the bucket.
+  virtual Time getEndTime() const = 0;
+  /// Returns the longest time until finish of any Motion in the bucket.
+  virtual Time timeUntilFinish() const = 0;
+
+  virtual size_t size() const = 0;
+  bool empty() const { return size() == 0; }
+
+  /// Returns an identifier unique to the bucket's value type. Matches the type key of the Motions it holds.
+  const void* getTypeKey() const { return _type_key; }
+
+private:
+  const void *_type_key;
+};
+
+///
+/// Evaluates Motion<T>s from contiguous arrays of their times, speeds, start times, targets, and current Phrases.
+///
+/// A Motion without an update function or update interval can be admitted while it plays inside one Phrase.
+/// Its time follows from its parent Timeline's park clock, as for a parked item, so stepping the bucket
+/// reads only the arrays, the Phrase, and the target; the Motion itself isn't touched.
+/// Start, finish, and inflection callbacks only fire where a Motion crosses a Phrase boundary,
+/// so the bucket wakes a Motion when it plays out of its Phrase and its Timeline steps it and fires them as usual.
+/// Anything that changes a Motion's timing, Sequence, or target wakes it first, like a parked item.
+///
+template<typename T>
+class MotionBucket : public MotionBucketBase
+{
+public:
+  MotionBucket():
+    MotionBucketBase( detail::typeKey<Motion<T>>() )
+  {}
+
+  bool admit( TimelineItemUniqueRef &item, Time park_clock ) override;
+  size_t step( Time park_clock, Time dt, const ParallelExecutor &executor, bool lazy, std::vector<const void*> *changes, std::vector<TimelineItemUniqueRef> &woken ) override;
+  void releaseUnparked( std::vector<TimelineItemUniqueRef> &destination ) override;
+  void forEach( const std::function<void (TimelineItem &)> &fn ) override;
+  void clear() override;
+
+  Time getEndTime() const override;
+  Time timeUntilFinish() const override;
+
+  size_t size() const override { return _motions.size(); }
+
+private:
+  /// Owning references to the Motions, for the rare paths that need the whole Motion.
+  std::vector<TimelineItemUniqueRef>  _motions;
+
+  // Everything evaluation reads, one element per Motion.
+  /// The Motion's time and park clock when admitted, so its time is _times + (park clock - _clocks) * _speeds - _start_times.
+  std::vector<Time>                   _times;
+  std::vector<Time>                   _clocks;
+  std::vector<Time>                   _speeds;
+  std::vector<Time>                   _start_times;
+  /// Span of Sequence time covered by the current Phrase. The bucket evaluates Motions strictly inside it.
+  std::vector<Time>                   _phrase_begins;
+  std::vector<Time>                   _phrase_ends;
+  /// The current Phrase. Owned by the Motion's Sequence, which can't change without waking the Motion.
+  std::vector<const Phrase<T>*>       _phrases;
+  std::vector<T*>                     _targets;
+  /// Connected OutputPool element's change flag, or null.
+  std::vector<uint8_t*>               _changed_flags;
+  /// Connected Output's stale flag, or null.
+  std::vector<bool*>                  _stale_flags;
+
+  /// Whether each current Phrase can be evaluated on worker threads, and how many can't.
+  std::vector<uint8_t>                _thread_safe;
+  size_t                              _unsafe_count = 0;
+
+  enum Status : uint8_t { Unchanged, Changed, Left };
+  /// What happened to each Motion during the last step.
+  std::vector<uint8_t>                _status;
+  /// Indices of Motions that left their Phrase during the last step.
+  std::vector<size_t>                 _left;
+
+  /// Evaluates Motions [begin, end) at \a park_clock, recording the results in _status.
+  void evaluate( size_t begin, size_t end, Time park_clock, bool lazy );
+  /// Removes the Motion at \a index, moving the last Motion into its place.
+  void removeAt( size_t index );
+
+  template<typename V>
+  static void swapRemove( std::vector<V> &elements, size_t index )
+  {
+    elements[index] = std::move( elements.back() );
+    elements.pop_back();
+  }
+};
+
+//=================================================
+// MotionBucket Template Implementation.
+//=================================================
+
+template<typename T>
+bool MotionBucket<T>::admit( TimelineItemUniqueRef &item, Time park_clock )
+{
+  auto &motion = static_cast<Motion<T>&>( *item );
+  if( motion._update_fn || motion.getUpdateInterval() > 0 || motion.cancelled() ) {
+    return false;
+  }
+
+  const auto &sequence = motion.source();
+  if( sequence.empty() ) {
+    return false;
+  }
+
+  // Times on a Phrase boundary, or outside the Sequence, are left to the Timeline.
+  const auto time = motion.time();
+  const auto index = sequence.seek( time, motion._cursor );
+  const auto begin = sequence.getTimeAtInflection( index );
+  const auto end = sequence.getTimeAtInflection( index + 1 );
+  if( ! (time > begin && time < end) ) {
+    return false;
+  }
+
+  const auto *phrase = sequence.getPhraseAtIndex( index ).get();
+  motion.parkAt( park_clock );
+
+  _times.push_back( motion._time );
+  _clocks.push_back( motion._parked_clock );
+  _speeds.push_back( motion.getPlaybackSpeed() );
+  _start_times.push_back( motion.getStartTime() );
+  _phrase_begins.push_back( begin );
+  _phrase_ends.push_back( end );
+  _phrases.push_back( phrase );
+  _targets.push_back( motion._target );
+  _changed_flags.push_back( motion._changed_flag );
+  _stale_flags.push_back( motion._stale_flag );
+  _thread_safe.push_back( phrase->isThreadSafe() );
+  _unsafe_count += _thread_safe.back() ? 0 : 1;
+  _motions.emplace_back( std::move( item ) );
+  return true;
+}
+
+template<typename T>
+void MotionBucket<T>::evaluate( size_t begin, size_t end, Time park_clock, bool lazy )
+{
+  for( size_t i = begin; i < end; i += 1 )
+  {
+    // Same arithmetic as TimelineItem::time() for a parked item.
+    const auto time = (_times[i] + (park_clock - _clocks[i]) * _speeds[i]) - _start_times[i];
+    if( ! (time > _phrase_begins[i] && time < _phrase_ends[i]) ) {
+      _status[i] = Left;
+    }
+    else if( lazy && _stale_flags[i] ) {
+      *_stale_flags[i] = true;
+      _status[i] = Unchanged;
+    }
+    else {
+      const bool changed = detail::assignIfChanged( *_targets[i], _phrases[i]->getValue( time - _phrase_begins[i] ) );
+      if( changed && _changed_flags[i] ) {
+        *_changed_flags[i] = 1;
+      }
+      if( _stale_flags[i] ) {
+        *_stale_flags[i] = false;
+      }
+      _status[i] = changed ? Changed : Unchanged;
+    }
+  }
+}
+
+template<typename T>
+size_t MotionBucket<T>::step( Time park_clock, Time dt, const ParallelExecutor &executor, bool lazy, std::vector<const void*> *changes, std::vector<TimelineItemUniqueRef> &woken )
+{
+  const auto count = _motions.size();
+  _status.resize( count );
+  if( executor && _unsafe_count == 0 ) {
+    executor( count, [this, park_clock, lazy] ( size_t begin, size_t end ) { evaluate( begin, end, park_clock, lazy ); } );
+  }
+  else {
+    evaluate( 0, count, park_clock, lazy );
+  }
+
+  _left.clear();
+  for( size_t i = 0; i < count; i += 1 )
+  {
+    if( _status[i] == Changed && changes ) {
+      changes->push_back( _targets[i] );
+    }
+    else if( _status[i] == Left ) {
+      _left.push_back( i );
+    }
+  }
+
+  // Later indices first, so the Motions moved into removed slots have already been checked.
+  for( auto iter = _left.rbegin(); iter != _left.rend(); ++iter )
+  {
+    auto &motion = _motions[*iter];
+    motion->unparkAt( park_clock - dt );
+    woken.emplace_back( std::move( motion ) );
+    removeAt( *iter );
+  }
+  return count - _left.size();
+}
+
+template<typename T>
+void MotionBucket<T>::releaseUnparked( std::vector<TimelineItemUniqueRef> &destination )
+{
+  for( size_t i = _motions.size(); i > 0; i -= 1 )
+  {
+    if( ! _motions[i - 1]->isParked() ) {
+      destination.emplace_back( std::move( _motions[i - 1] ) );
+      removeAt( i - 1 );
+    }
+  }
+}
+
+template<typename T>
+void MotionBucket<T>::removeAt( size_t index )
+{
+  _unsafe_count -= _thread_safe[index] ? 0 : 1;
+  swapRemove( _motions, index );
+  swapRemove( _times, index );
+  swapRemove( _clocks, index );
+  swapRemove( _speeds, index );
+  swapRemove( _start_times, index );
+  swapRemove( _phrase_begins, index );
+  swapRemove( _phrase_ends, index );
+  swapRemove( _phrases, index );
+  swapRemove( _targets, index );
+  swapRemove( _changed_flags, index );
+  swapRemove( _stale_flags, index );
+  swapRemove( _thread_safe, index );
+}
+
+template<typename T>
+void MotionBucket<T>::forEach( const std::function<void (TimelineItem &)> &fn )
+{
+  for( auto &motion : _motions ) {
+    fn( *motion );
+  }
+}
+
+template<typename T>
+void MotionBucket<T>::clear()
+{
+  _motions.clear();
+  for( auto *array : { &_times, &_clocks, &_speeds, &_start_times, &_phrase_begins, &_phrase_ends } ) {
+    array->clear();
+  }
+  _phrases.clear();
+  _targets.clear();
+  _changed_flags.clear();
+  _stale_flags.clear();
+  _thread_safe.clear();
+  _unsafe_count = 0;
+}
+
+template<typename T>
+Time MotionBucket<T>::getEndTime() const
+{
+  Time end = 0;
+  for( auto &motion : _motions ) {
+    end = std::max( end, motion->getEndTime() );
+  }
+  return end;
+}
+
+template<typename T>
+Time MotionBucket<T>::timeUntilFinish() const
+{
+  Time end = 0;
+  for( auto &motion : _motions ) {
+    end = std::max( end, motion->getTimeUntilFinish() );
+  }
+  return end;
+}
+
+} // namespace detail
+} // namespace choreograph
@@ -0,0 +1,170 @@
+/*
+ * Copyright (c) 2014 David Wicks, sansumbrella.com
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace choreograph
+{
+namespace detail
+{
+
+/// Returns an address unique to type \a T. Cheaper to compare than typeid and needs no RTTI.
+/// The key is writable so identical code folding can't merge the keys of different types.
+template<typename T>
+const void* typeKey() { static char key; return &key; }
+
+///
+/// Open-addressing hash map from addresses to non-owning pointers.
+/// Uses linear probing with backward-shift deletion, so lookups never wade through tombstones.
+/// Null keys are not allowed; a null key marks an empty slot.
+///
+template<typename V>
+class PointerMap
+{
+public:
+  /// Returns the value stored for \a key, or nullptr if there is none.
+  V* find( const void *key ) const
+  {
+    if( _slots.empty() ) {
+      return nullptr;
+    }
+    for( size_t i = home( key ); _slots[i].key; i = (i + 1) & mask() ) {
+      if( _slots[i].key == key ) {
+        return _slots[i].value;
+      }
+    }
+    return nullptr;
+  }
+
+  /// Stores \a value for \a key, replacing any previous value.
+  void set( const void *key, V *value )
+  {
+    if( (_size + 1) * 2 > _slots.size() ) {
+      grow();
+    }
+
+    size_t i = home( key );
+    while( _slots[i].key && _slots[i].key != key ) {
+      i = (i + 1) & mask();
+    }
+    if( ! _slots[i].key ) {
+      _slots[i].key = key;
+      _size += 1;
+    }
+    _slots[i].value = value;
+  }
+
+  /// Removes \a key from the map if present.
+  void erase( const void *key )
+  {
+    if( _slots.empty() ) {
+      return;
+    }
+
+    size_t i = home( key );
+    while( _slots[i].key != key ) {
+      if( ! _slots[i].key ) {
+        return;
+      }
+      i = (i + 1) & mask();
+    }
+
+    // Shift later members of the probe run back into the hole, unless that would move them before their home slot.
+    size_t j = i;
+    while( true )
+    {
+      j = (j + 1) & mask();
+      if( ! _slots[j].key ) {
+        break;
+      }
+      const auto k = home( _slots[j].key );
+      const bool stays = (i <= j) ? (i < k && k <= j) : (i < k || k <= j);
+      if( ! stays ) {
+        _slots[i] = _slots[j];
+        i = j;
+      }
+    }
+    _slots[i] = Slot();
+    _size -= 1;
+  }
+
+  /// Removes all keys. Keeps the allocated slots.
+  void clear()
+  {
+    std::fill( _slots.begin(), _slots.end(), Slot() );
+    _size = 0;
+  }
+
+  size_t size() const { return _size; }
+  bool empty() const { return _size == 0; }
+
+private:
+  struct Slot
+  {
+    const void  *key = nullptr;
+    V           *value = nullptr;
+  };
+
+  static const size_t MinCapacity = 16;
+
+  /// Capacity is always zero or a power of two.
+  std::vector<Slot> _slots;
+  size_t            _size = 0;
+
+  size_t mask() const { return _slots.size() - 1; }
+
+  /// Returns the first slot to probe for \a key.
+  size_t home( const void *key ) const
+  {
+    // Mix the address bits, since allocations share their low bits.
+    auto h = static_cast<uint64_t>( reinterpret_cast<uintptr_t>( key ) );
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    return static_cast<size_t>( h ) & mask();
+  }
+
+  void grow()
+  {
+    std::vector<Slot> previous( _slots.empty() ? size_t( MinCapacity ) : _slots.size() * 2 );
+    previous.swap( _slots );
+    _size = 0;
+    for( auto &slot : previous ) {
+      if( slot.key ) {
+        set( slot.key, slot.value );
+      }
+    }
+  }
+};
+
+} // namespace detail
+} // namespace choreograph
@@ -0,0 +1,228 @@
+/*
+ * Copyright (c) 2014 David Wicks, sansumbrella.com
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or
+ * without modification, are permitted provided that the following
+ * conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <vector>
+
+namespace choreograph
+{
+namespace detail
+{
+
+/// Returns the number of blocks the small block caches and allocateSmall() have taken from the global heap, across all threads.
+/// Stays the same while objects are created and destroyed in a steady state.
+inline std::atomic<size_t>& smallHeapAllocationCount()
+{
+  static std::atomic<size_t> count( 0 );
+  return count;
+}
+
+///
+/// Per-thread cache of freed small blocks, sorted into size classes.
+/// Blocks come from the global heap the first time a size class runs dry.
+/// When freed they are kept for reuse, up to MaxCachedBytes per thread across all size classes.
+/// Creating and destroying objects in a steady state therefore doesn't touch the global heap.
+///
+/// Cached blocks are held until trim() is called or the thread exits.
+/// Threads that free many objects once and then go quiet should call releaseCachedBlocks().
+///
+class SmallBlockCache
+{
+public:
+  static const size_t Granularity = 16;
+  static const size_t MaxBlockSize = 512;
+  /// Most bytes a thread keeps cached, summed over all size classes.
+  static const size_t MaxCachedBytes = 1 << 20;
+
+  SmallBlockCache() = default;
+  SmallBlockCache( const SmallBlockCache &rhs ) = delete;
+  SmallBlockCache& operator= ( const SmallBlockCache &rhs ) = delete;
+
+  ~SmallBlockCache() { trim(); }
+
+  /// Returns every cached block to the global heap.
+  void trim()
+  {
+    for( auto &list : _lists ) {
+      while( list.head ) {
+        auto block = list.head;
+        list.head = block->next;
+        ::operator delete( block );
+      }
+      list.count = 0;
+    }
+    _cached_bytes = 0;
+  }
+
+  /// Returns the number of bytes held in freed blocks waiting for reuse.
+  size_t cachedBytes() const { return _cached_bytes; }
+
+  /// Returns a block of at least \a size bytes. \a size must not exceed MaxBlockSize.
+  void* allocate( size_t size )
+  {
+    auto &list = _lists[sizeClass( size )];
+    if( list.head ) {
+      auto block = list.head;
+      list.head = block->next;
+      list.count -= 1;
+      _cached_bytes -= blockSize( size );
+      return block;
+    }
+    smallHeapAllocationCount() += 1;
+    return ::operator new( blockSize( size ) );
+  }
+
+  /// Returns a block allocated with the same \a size to the cache.
+  void deallocate( void *ptr, size_t size )
+  {
+    if( _cached_bytes + blockSize( size ) > MaxCachedBytes ) {
+      ::operator delete( ptr );
+      return;
+    }
+    auto &list = _lists[sizeClass( size )];
+    auto block = static_cast<FreeBlock*>( ptr );
+    block->next = list.head;
+    list.head = block;
+    list.count += 1;
+    _cached_bytes += blockSize( size );
+  }
+
+  static size_t sizeClass( size_t size ) { return size == 0 ? 0 : (size - 1) / Granularity; }
+  static size_t blockSize( size_t size ) { return (sizeClass( size ) + 1) * Granularity; }
+
+private:
+  struct FreeBlock
+  {
+    FreeBlock *next;
+  };
+
+  struct FreeList
+  {
+    FreeBlock *head = nullptr;
+    size_t    count = 0;
+  };
+
+  std::array<FreeList, MaxBlockSize / Granularity> _lists;
+  size_t                                           _cached_bytes = 0;
+};
+
+/// Returns this thread's block cache, or nullptr if the thread is shutting down and the cache is gone.
+inline SmallBlockCache* localBlockCache()
+{
+  // Trivially destructible, so it can still be read while thread_local objects are destroyed.
+  static thread_local bool destroyed = false;
+  struct Holder
+  {
+    ~Holder() { destroyed = true; }
+    SmallBlockCache cache;
+  };
+  static thread_local Holder holder;
+  return destroyed ? nullptr : &holder.cache;
+}
+
+/// Returns the calling thread's cached blocks to the global heap.
+/// Later small allocations on the thread refill its cache from the heap.
+inline void releaseCachedBlocks()
+{
+  if( auto cache = localBlockCache() ) {
+    cache->trim();
+  }
+}
+
+/// Allocates \a size bytes, from the calling thread's cache if the size is small.
+inline void* allocateSmall( size_t size )
+{
+  if( size <= SmallBlockCache::MaxBlockSize ) {
+    if( auto cache = localBlockCache() ) {
+      return cache->allocate( size );
+    }
+    smallHeapAllocationCount() += 1;
+    return ::operator new( SmallBlockCache::blockSize( size ) );
+  }
+  smallHeapAllocationCount() += 1;
+  return ::operator new( size );
+}
+
+/// Releases memory from allocateSmall(). \a size must match the allocated size.
+/// May be called from any thread; small blocks go to the calling thread's cache.
+inline void deallocateSmall( void *ptr, size_t size )
+{
+  if( size <= SmallBlockCache::MaxBlockSize ) {
+    if( auto cache = localBlockCache() ) {
+      cache->deallocate( ptr, size );
+      return;
+    }
+  }
+  ::operator delete( ptr );
+}
+
+///
+/// Standard allocator backed by allocateSmall().
+///
+template<typename T>
+class PoolAllocator
+{
+public:
+  using value_type = T;
+
+  PoolAllocator() = default;
+  template<typename U>
+  PoolAllocator( const PoolAllocator<U> & ) {}
+
+  T* allocate( size_t n )
+  {
+    static_assert( alignof( T ) <= alignof( std::max_align_t ), "PoolAllocator doesn't support over-aligned types." );
+    return static_cast<T*>( allocateSmall( n * sizeof( T ) ) );
+  }
+
+  void deallocate( T *ptr, size_t n ) { deallocateSmall( ptr, n * sizeof( T ) ); }
+
+  template<typename U>
+  bool operator== ( const PoolAllocator<U> & ) const { return true; }
+  template<typename U>
+  bool operator!= ( const PoolAllocator<U> & ) const { return false; }
+};
+
+/// Vector whose storage comes from the small block caches.
+template<typename T>
+using PooledVector = std::vector<T, PoolAllocator<T>>;
+
+/// Like std::make_shared, but allocates the object and its control block from the small block caches.
+template<typename T, typename... Args>
+std::shared_ptr<T> make_pooled( Args&&... args )
+{
+  return std::allocate_shared<T>( PoolAllocator<T>(), std::forward<Args>( args )... );
+}
+
+} // namespace detail
+} // namespace choreograph
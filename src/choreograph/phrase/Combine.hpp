@@ -77,6 +77,9 @@ public:
   /// Returns a pointer to the mix output for animation with a choreograph::Motion.
   Output<float>* getMixOutput() { return &_mix; }
 
+  /// The mix may be animated by another Motion while this Phrase is evaluated, so it isn't evaluated on worker threads.
+  bool isThreadSafe() const override { return false; }
+
 private:
   Output<float> _mix = 0.5f;
   PhraseRef<T>  _a;
@@ -156,6 +159,9 @@ public:
     return value;
   }
 
+  /// Sources may be changed and the reduce function may have side effects, so this Phrase isn't evaluated on worker threads.
+  bool isThreadSafe() const override { return false; }
+
   /// Default reduce function sums all inputs.
   static T sum( const T &a, const T &b ) {
     return a + b;
@@ -212,6 +218,16 @@ class RaisePhrase : public Phrase<T>
     return out;
   }
 
+  bool isThreadSafe() const override
+  {
+    for( const auto &source : _sources ) {
+      if( ! source->isThreadSafe() ) {
+        return false;
+      }
+    }
+    return true;
+  }
+
 private:
   std::vector<PhraseRef<ComponentT>> _sources;
 };
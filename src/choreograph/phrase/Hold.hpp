@@ -57,6 +57,18 @@ public:
     return _value;
   }
 
+  void getValues( const Time * /*times*/, T *out, size_t count ) const override
+  {
+    std::fill( out, out + count, _value );
+  }
+
+  bool getConstantSpan( Time /*at_time*/, Time *begin, Time *end ) const override
+  {
+    *begin = 0;
+    *end = this->getDuration();
+    return true;
+  }
+
 private:
   T       _value;
 };
@@ -55,6 +55,9 @@ public:
     return _function( this->normalizeTime( atTime ), this->getDuration() );
   }
 
+  /// The function may have side effects or read shared state, so Motions playing this Phrase are evaluated on the updating thread.
+  bool isThreadSafe() const override { return false; }
+
 private:
   Function  _function;
 };
@@ -29,6 +29,7 @@
 
 #include "choreograph/Phrase.hpp"
 #include "choreograph/Easing.h"
+#include "choreograph/BatchEasing.h"
 
 ///
 /// \file
@@ -73,6 +74,15 @@ public:
     return _lerp_fn( _start_value, _end_value, _ease_fn( this->normalizeTime( at_time ) ) );
   }
 
+  /// Eases one time at a time; the ease is type-erased, so easeBatch() can't be used.
+  /// Use StaticRampTo for batched easing.
+  void getValues( const Time *times, T *out, size_t count ) const override
+  {
+    for( size_t i = 0; i < count; i += 1 ) {
+      out[i] = _lerp_fn( _start_value, _end_value, _ease_fn( this->normalizeTime( times[i] ) ) );
+    }
+  }
+
   T getStartValue() const override { return _start_value; }
   T getEndValue() const override { return _end_value; }
 
@@ -88,6 +98,61 @@ private:
   LerpFn  _lerp_fn;
 };
 
+///
+/// StaticRampTo is a RampTo whose ease and lerp functions are part of its type.
+/// Stateless functors like EaseInOutQuad and Lerp<T> are inlined into getValue(),
+/// avoiding the two std::function calls RampTo makes per sample.
+/// Usually created through Sequence::rampTo() or MotionOptions::rampTo().
+///
+template<typename T, typename EaseT = EaseNone, typename LerpT = Lerp<T>>
+class StaticRampTo : public Phrase<T>
+{
+public:
+  StaticRampTo( Time duration, const T &start_value, const T &end_value, const EaseT &ease_fn = EaseT(), const LerpT &lerp_fn = LerpT() ):
+    Phrase<T>( duration ),
+    _start_value( start_value ),
+    _end_value( end_value ),
+    _ease_fn( ease_fn ),
+    _lerp_fn( lerp_fn )
+  {}
+
+  /// Returns the interpolated value at the given time.
+  T getValue( Time at_time ) const override
+  {
+    return _lerp_fn( _start_value, _end_value, _ease_fn( this->normalizeTime( at_time ) ) );
+  }
+
+  /// Eases chunks of times with easeBatch() before interpolating.
+  /// Eases are within BatchEaseTolerance of those getValue() computes, see BatchEasing.h.
+  void getValues( const Time *times, T *out, size_t count ) const override
+  {
+    float eased[detail::SampleChunkSize];
+    for( size_t offset = 0; offset < count; offset += detail::SampleChunkSize )
+    {
+      const auto n = std::min( detail::SampleChunkSize, count - offset );
+      for( size_t i = 0; i < n; i += 1 ) {
+        eased[i] = (float)this->normalizeTime( times[offset + i] );
+      }
+      easeBatch( _ease_fn, eased, eased, n );
+      for( size_t i = 0; i < n; i += 1 ) {
+        out[offset + i] = _lerp_fn( _start_value, _end_value, eased[i] );
+      }
+    }
+  }
+
+  T getStartValue() const override { return _start_value; }
+  T getEndValue() const override { return _end_value; }
+
+  void setStartValue( const T &value ) { _start_value = value; }
+  void setEndValue( const T &value ) { _end_value = value; }
+
+private:
+  T       _start_value;
+  T       _end_value;
+  EaseT   _ease_fn;
+  LerpT   _lerp_fn;
+};
+
 ///
 /// RampToN is a phrase template with N separately-interpolated components of the same type.
 /// Allows for the use of separate ease functions per component.
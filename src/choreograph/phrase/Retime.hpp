@@ -55,6 +55,7 @@ public:
   T getValue( Time atTime ) const override { return _source->getValueWrapped( atTime, _inflection_point ); }
   T getStartValue() const override { return _source->getStartValue(); }
   T getEndValue() const override { return _source->getValueWrapped( this->getDuration() ); }
+  bool isThreadSafe() const override { return _source->isThreadSafe(); }
 private:
   PhraseRef<T>  _source;
   Time          _inflection_point;
@@ -88,6 +89,7 @@ public:
   }
   T getStartValue() const override { return _source->getStartValue(); }
   T getEndValue() const override { return getValue( this->getDuration() ); }
+  bool isThreadSafe() const override { return _source->isThreadSafe(); }
 private:
   PhraseRef<T>  _source;
   Time          _inflection_point;
@@ -109,6 +111,7 @@ public:
   T getValue( Time atTime ) const override { return _source->getValue( _source->getDuration() - atTime ); }
   T getStartValue() const override { return _source->getEndValue(); }
   T getEndValue() const override { return _source->getStartValue(); }
+  bool isThreadSafe() const override { return _source->isThreadSafe(); }
 private:
   PhraseRef<T>  _source;
 };
@@ -131,6 +134,18 @@ public:
 
   T getValue( Time atTime ) const override { return _source->getValue( clampTime( _begin + atTime ) ); }
 
+  bool getConstantSpan( Time at_time, Time *begin, Time *end ) const override
+  {
+    if( _source->getConstantSpan( clampTime( _begin + at_time ), begin, end ) ) {
+      *begin -= _begin;
+      *end -= _begin;
+      return true;
+    }
+    return false;
+  }
+
+  bool isThreadSafe() const override { return _source->isThreadSafe(); }
+
   Time clampTime( Time t ) const { return std::min( std::min( t, _source->getDuration() ), _end ); }
 private:
   PhraseRef<T>  _source;
@@ -149,6 +164,7 @@ public:
   {}
 
   T getValue( Time atTime ) const override { return _source->getValue( stretchTime( atTime ) ); }
+  bool isThreadSafe() const override { return _source->isThreadSafe(); }
   Time stretchTime( Time t ) const { return (t / _source_duration) * _new_duration; }
 private:
   PhraseRef<T> _source;
@@ -46,35 +46,35 @@ namespace choreograph
 template<typename T>
 inline PhraseRef<T> makeRepeat( const PhraseRef<T> &source, float numLoops, Time inflectionPoint = 0.0f )
 {
-  return std::make_shared<LoopPhrase<T>>( source, numLoops, inflectionPoint );
+  return detail::make_pooled<LoopPhrase<T>>( source, numLoops, inflectionPoint );
 }
 
 /// Create a Phrase that loops \a source Phrase \a numLoops times.
 template<typename T>
 inline PhraseRef<T> makePingPong( const PhraseRef<T> &source, float numLoops, Time inflectionPoint = 0.0f )
 {
-  return std::make_shared<PingPongPhrase<T>>( source, numLoops, inflectionPoint );
+  return detail::make_pooled<PingPongPhrase<T>>( source, numLoops, inflectionPoint );
 }
 
 /// Create a Phrase that plays \a source Phrase in reverse.
 template<typename T>
 inline PhraseRef<T> makeReverse( const PhraseRef<T> &source )
 {
-  return std::make_shared<ReversePhrase<T>>( source );
+  return detail::make_pooled<ReversePhrase<T>>( source );
 }
 
 /// Create a MixPhrase that blends the value of Phrases \a a and \a b.
 template<typename T>
 inline std::shared_ptr<MixPhrase<T>> makeBlend( const PhraseRef<T> &a, const PhraseRef<T> &b, float mix = 0.5f, const typename MixPhrase<T>::LerpFn &lerp_fn = &lerpT<T> )
 {
-  return std::make_shared<MixPhrase<T>>( a, b, mix, lerp_fn );
+  return detail::make_pooled<MixPhrase<T>>( a, b, mix, lerp_fn );
 }
 
 /// Create a RampTo that animates from \a a to \a b.
 template<typename T>
 inline std::shared_ptr<RampTo<T>> makeRamp( const T &a, const T &b, Time duration, const EaseFn &ease_fn = &easeNone, const typename RampTo<T>::LerpFn &lerp_fn = &lerpT<T> )
 {
-  return std::make_shared<RampTo<T>>( duration, a, b, ease_fn, lerp_fn );
+  return detail::make_pooled<RampTo<T>>( duration, a, b, ease_fn, lerp_fn );
 }
 
 /// Create an AccumulatePhrase that combines the values of input Phrases via a left fold.
@@ -83,9 +83,9 @@ template<typename T>
 inline std::shared_ptr<AccumulatePhrase<T>> makeAccumulator( const T &initial_value, const PhraseRef<T> &a, const PhraseRef<T> &b, const typename AccumulatePhrase<T>::CombineFunction &fn = &AccumulatePhrase<T>::sum, Time duration=0 )
 {
   if( duration > 0 )
-    return std::make_shared<AccumulatePhrase<T>>( duration, initial_value, a, b, fn );
+    return detail::make_pooled<AccumulatePhrase<T>>( duration, initial_value, a, b, fn );
   else
-    return std::make_shared<AccumulatePhrase<T>>( initial_value, a, b, fn );
+    return detail::make_pooled<AccumulatePhrase<T>>( initial_value, a, b, fn );
 }
 
 /// Create an AccumulatedPhrase that sums a phrase with an initial value.
@@ -94,9 +94,9 @@ template<typename T>
 inline std::shared_ptr<AccumulatePhrase<T>> makeAccumulator( const T &initial_value, const PhraseRef<T> &a, Time duration=0 )
 {
 if( duration > 0 )
-  return std::make_shared<AccumulatePhrase<T>>( duration, initial_value, a );
+  return detail::make_pooled<AccumulatePhrase<T>>( duration, initial_value, a );
 else
-  return std::make_shared<AccumulatePhrase<T>>( initial_value, a );
+  return detail::make_pooled<AccumulatePhrase<T>>( initial_value, a );
 }
 
 ///
@@ -105,7 +105,7 @@ else
 template<typename T>
 inline PhraseRef<T> makeProcedure( Time duration, const typename ProceduralPhrase<T>::Function &fn )
 {
-  return std::make_shared<ProceduralPhrase<T>>( duration, fn );
+  return detail::make_pooled<ProceduralPhrase<T>>( duration, fn );
 }
 
 } // namespace choreograph
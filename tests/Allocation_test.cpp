@@ -0,0 +1,207 @@
+//
+//  Allocation_test.cpp
+//
+//  Counts every global heap allocation, so it builds as its own executable.
+//  Other tests and sanitizers keep the standard operator new.
+//
+
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+#include "choreograph/Choreograph.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+using namespace choreograph;
+using namespace std;
+
+namespace
+{
+
+std::atomic<size_t> sHeapAllocations( 0 );
+
+void* countedAllocate( size_t size )
+{
+  sHeapAllocations += 1;
+  return std::malloc( size ? size : 1 );
+}
+
+void* countedAllocateOrThrow( size_t size )
+{
+  if( auto ptr = countedAllocate( size ) ) {
+    return ptr;
+  }
+  throw std::bad_alloc();
+}
+
+void countedRelease( void *ptr )
+{
+  std::free( ptr );
+}
+
+#if defined( __cpp_aligned_new )
+
+void* countedAllocateAligned( size_t size, std::align_val_t alignment )
+{
+  sHeapAllocations += 1;
+#if defined( _MSC_VER )
+  return _aligned_malloc( size ? size : 1, static_cast<size_t>( alignment ) );
+#else
+  void *ptr = nullptr;
+  return posix_memalign( &ptr, static_cast<size_t>( alignment ), size ? size : 1 ) == 0 ? ptr : nullptr;
+#endif
+}
+
+void* countedAllocateAlignedOrThrow( size_t size, std::align_val_t alignment )
+{
+  if( auto ptr = countedAllocateAligned( size, alignment ) ) {
+    return ptr;
+  }
+  throw std::bad_alloc();
+}
+
+void countedReleaseAligned( void *ptr )
+{
+#if defined( _MSC_VER )
+  _aligned_free( ptr );
+#else
+  std::free( ptr );
+#endif
+}
+
+#endif
+
+/// Returns the number of global heap allocations made while calling \a fn.
+template<typename Fn>
+size_t countAllocations( Fn &&fn )
+{
+  auto before = sHeapAllocations.load();
+  fn();
+  return sHeapAllocations.load() - before;
+}
+
+} // namespace
+
+//=================================================
+// Replacements for every form of global operator new and delete.
+//=================================================
+
+void* operator new( size_t size ) { return countedAllocateOrThrow( size ); }
+void* operator new[]( size_t size ) { return countedAllocateOrThrow( size ); }
+void* operator new( size_t size, const std::nothrow_t & ) noexcept { return countedAllocate( size ); }
+void* operator new[]( size_t size, const std::nothrow_t & ) noexcept { return countedAllocate( size ); }
+
+void operator delete( void *ptr ) noexcept { countedRelease( ptr ); }
+void operator delete[]( void *ptr ) noexcept { countedRelease( ptr ); }
+void operator delete( void *ptr, const std::nothrow_t & ) noexcept { countedRelease( ptr ); }
+void operator delete[]( void *ptr, const std::nothrow_t & ) noexcept { countedRelease( ptr ); }
+void operator delete( void *ptr, size_t ) noexcept { countedRelease( ptr ); }
+void operator delete[]( void *ptr, size_t ) noexcept { countedRelease( ptr ); }
+
+#if defined( __cpp_aligned_new )
+void* operator new( size_t size, std::align_val_t alignment ) { return countedAllocateAlignedOrThrow( size, alignment ); }
+void* operator new[]( size_t size, std::align_val_t alignment ) { return countedAllocateAlignedOrThrow( size, alignment ); }
+void* operator new( size_t size, std::align_val_t alignment, const std::nothrow_t & ) noexcept { return countedAllocateAligned( size, alignment ); }
+void* operator new[]( size_t size, std::align_val_t alignment, const std::nothrow_t & ) noexcept { return countedAllocateAligned( size, alignment ); }
+
+void operator delete( void *ptr, std::align_val_t ) noexcept { countedReleaseAligned( ptr ); }
+void operator delete[]( void *ptr, std::align_val_t ) noexcept { countedReleaseAligned( ptr ); }
+void operator delete( void *ptr, std::align_val_t, const std::nothrow_t & ) noexcept { countedReleaseAligned( ptr ); }
+void operator delete[]( void *ptr, std::align_val_t, const std::nothrow_t & ) noexcept { countedReleaseAligned( ptr ); }
+void operator delete( void *ptr, size_t, std::align_val_t ) noexcept { countedReleaseAligned( ptr ); }
+void operator delete[]( void *ptr, size_t, std::align_val_t ) noexcept { countedReleaseAligned( ptr ); }
+#endif
+
+//=================================================
+// Tests.
+//=================================================
+
+TEST_CASE( "Allocation Counting" )
+{
+  SECTION( "Every form of operator new is counted." )
+  {
+    auto count = countAllocations( [] {
+      delete new int( 1 );
+      delete[] new int[4];
+      delete new (std::nothrow) int( 1 );
+      delete[] new (std::nothrow) int[4];
+    } );
+    REQUIRE( count == 4 );
+
+#if defined( __cpp_aligned_new )
+    struct alignas( 64 ) Aligned { float values[16]; };
+    count = countAllocations( [] {
+      delete new Aligned;
+      delete[] new Aligned[4];
+      delete new (std::nothrow) Aligned;
+      delete[] new (std::nothrow) Aligned[4];
+    } );
+    REQUIRE( count == 4 );
+#endif
+  }
+}
+
+TEST_CASE( "Steady State Allocation" )
+{
+  ch::Timeline timeline;
+  vector<Output<float>> outputs( 500 );
+  int finished = 0;
+
+  auto churn = [&] {
+    for( auto &output : outputs ) {
+      timeline.apply( &output )
+        .then<RampTo>( 10.0f, 0.25f, EaseInOutQuad() )
+        .rampTo( 5.0f, 0.25f, EaseOutCubic() )
+        .hold( 0.1f )
+        .finishFn( [&finished] { finished += 1; } )
+        .getControl();
+    }
+    timeline.cue( [] {}, 0.3f );
+    while( ! timeline.empty() ) {
+      timeline.step( 0.1f );
+    }
+  };
+
+  SECTION( "Creating and finishing Motions in a steady state doesn't touch the heap." )
+  {
+    // Warm up the caches.
+    churn();
+    churn();
+
+    auto count = countAllocations( churn );
+
+    REQUIRE( finished == 1500 );
+    REQUIRE( count == 0 );
+  }
+
+  SECTION( "Bucketed Motions don't touch the heap in a steady state, either." )
+  {
+    timeline.setMotionStorage( MotionStorage::Bucketed );
+    churn();
+    churn();
+
+    REQUIRE( countAllocations( churn ) == 0 );
+  }
+
+  SECTION( "Handles don't allocate." )
+  {
+    vector<TimelineItemHandle> handles;
+    handles.reserve( outputs.size() );
+    auto apply_with_handles = [&] {
+      for( auto &output : outputs ) {
+        handles.push_back( timeline.apply( &output ).rampTo( 1.0f, 0.2f ).getHandle() );
+      }
+      handles[0].cancel();
+      while( ! timeline.empty() ) {
+        timeline.step( 0.1f );
+      }
+      handles.clear();
+    };
+
+    apply_with_handles();
+    apply_with_handles();
+
+    REQUIRE( countAllocations( apply_with_handles ) == 0 );
+  }
+}
@@ -9,6 +9,7 @@
 #include "cinder/Timer.h"
 
 #include <chrono>
+#include <cstring>
 
 using namespace std;
 using cinder::Timeline;
@@ -95,6 +96,93 @@ TEST_CASE( "Sequence Manipulation Timing" )
   auto sub_huge = huge_sequence.slice( 5.55f, 15000.025f );
   slice_huge.stop();
   printTiming( "Slicing Huge Sequence", slice_huge.getSeconds() * 1000 );
+
+  Timer evaluate_huge( true );
+  float sum = 0.0f;
+  for( int i = 0; i < 1000; i += 1 ) {
+    sum += huge_sequence.getValue( huge_sequence.getDuration() * i / 1000.0 );
+  }
+  evaluate_huge.stop();
+  printTiming( "Evaluating Huge Sequence 1000 times", evaluate_huge.getSeconds() * 1000 );
+
+  Timer evaluate_huge_cursor( true );
+  SequenceCursor cursor;
+  for( int i = 0; i < 1000; i += 1 ) {
+    sum += huge_sequence.getValue( huge_sequence.getDuration() * i / 1000.0, cursor );
+  }
+  evaluate_huge_cursor.stop();
+  printTiming( "Evaluating Huge Sequence 1000 times in order with a cursor", evaluate_huge_cursor.getSeconds() * 1000 );
+
+  vector<float> samples( 1000 );
+  Timer sample_huge( true );
+  huge_sequence.sample( 0.0, huge_sequence.getDuration() / 1000.0, samples.size(), samples.data() );
+  sample_huge.stop();
+  printTiming( "Sampling Huge Sequence 1000 times", sample_huge.getSeconds() * 1000 );
+}
+
+TEST_CASE( "Ramp Evaluation Timing" )
+{
+  const int count = 10e6;
+  printHeading( "Evaluating Ramps " + to_string( count ) + " times" );
+
+  auto dynamic_ramp = makeRamp( vec2( 0 ), vec2( 10 ), 1.0f, EaseInOutQuad() );
+  auto static_ramp = make_shared<StaticRampTo<vec2, EaseInOutQuad>>( 1.0f, vec2( 0 ), vec2( 10 ) );
+  PhraseRef<vec2> dynamic_phrase = dynamic_ramp;
+  PhraseRef<vec2> static_phrase = static_ramp;
+
+  vec2 sum( 0 );
+  Timer dynamic_timer( true );
+  for( int i = 0; i < count; i += 1 ) {
+    sum += dynamic_phrase->getValue( (Time)i / count );
+  }
+  dynamic_timer.stop();
+  printTiming( "RampTo with std::function", dynamic_timer.getSeconds() * 1000 );
+
+  Timer static_timer( true );
+  for( int i = 0; i < count; i += 1 ) {
+    sum += static_phrase->getValue( (Time)i / count );
+  }
+  static_timer.stop();
+  printTiming( "StaticRampTo through Phrase", static_timer.getSeconds() * 1000 );
+
+  Timer inlined_timer( true );
+  for( int i = 0; i < count; i += 1 ) {
+    sum += static_ramp->StaticRampTo<vec2, EaseInOutQuad>::getValue( (Time)i / count );
+  }
+  inlined_timer.stop();
+  printTiming( "StaticRampTo called directly", inlined_timer.getSeconds() * 1000 );
+  REQUIRE( sum.x > 0 );
+}
+
+TEST_CASE( "Batch Easing Timing" )
+{
+  const size_t count = 1e6;
+  printHeading( "Easing " + to_string( count ) + " times" );
+
+  vector<float> times( count );
+  vector<float> results( count );
+  for( size_t i = 0; i < count; i += 1 ) {
+    times[i] = (float)i / count;
+  }
+
+  auto compare = [&] ( const std::string &name, auto ease ) {
+    Timer scalar( true );
+    for( size_t i = 0; i < count; i += 1 ) {
+      results[i] = ease( times[i] );
+    }
+    scalar.stop();
+    printTiming( name + " scalar", scalar.getSeconds() * 1000 );
+
+    Timer batch( true );
+    easeBatch( ease, times.data(), results.data(), count );
+    batch.stop();
+    printTiming( name + " batch", batch.getSeconds() * 1000 );
+  };
+
+  compare( "EaseInOutQuad", EaseInOutQuad() );
+  compare( "EaseOutBounce", EaseOutBounce() );
+  compare( "EaseInOutElastic", EaseInOutElastic( 1.0f, 0.3f ) );
+  compare( "EaseInOutSine", EaseInOutSine() );
 }
 
 TEST_CASE( "Choreograph Timeline Basic Performance" )
@@ -156,6 +244,591 @@ TEST_CASE( "Choreograph Timeline Basic Performance" )
   step_copy_created.stop();
   printTiming( "60 Motion Steps (1sec at 60Hz)", step_copy_created.getSeconds() * 1000 );
 
+  auto shared = std::make_shared<const Sequence<vec2>>( sequence );
+  Timer create_shared( true );
+  for( auto &target : targets ) {
+    choreograph_timeline.apply( &target, shared );
+  }
+  create_shared.stop();
+  printTiming( "Creating Motions from shared Sequence", create_shared.getSeconds() * 1000 );
+
+  Timer create_copied_plain( true );
+  for( auto &target : targets ) {
+    choreograph_timeline.apply( &target, sequence );
+  }
+  create_copied_plain.stop();
+  printTiming( "Creating Motions from copied Sequence", create_copied_plain.getSeconds() * 1000 );
+}
+
+TEST_CASE( "Parallel Timeline Performance" )
+{
+  const size_t count = 100e3;
+  const float dt = 1.0f / 60.0f;
+  printHeading( "Serial and Parallel Steps for " + to_string( count ) + " Motions" );
+
+  ch::ThreadPool pool;
+  vector<Output<vec2>> serial_targets( count );
+  vector<Output<vec2>> parallel_targets( count );
+  ch::Timeline serial_timeline;
+  ch::Timeline parallel_timeline;
+  parallel_timeline.setParallelExecutor( pool.getExecutor() );
+
+  Sequence<vec2> sequence( vec2( 1.0f ) );
+  sequence.then<RampTo>( vec2( 5.0f ), 1.0f, EaseInOutQuad() ).then<RampTo>( vec2( 10.0f, 6.0f ), 0.5f, EaseOutBack() );
+  for( size_t i = 0; i < count; i += 1 ) {
+    serial_timeline.apply( &serial_targets[i], sequence ).finishFn( [] {} );
+    parallel_timeline.apply( &parallel_targets[i], sequence ).finishFn( [] {} );
+  }
+
+  Timer serial_step( true );
+  for( int i = 0; i < 60; ++i ) {
+    serial_timeline.step( dt );
+  }
+  serial_step.stop();
+
+  Timer parallel_step( true );
+  for( int i = 0; i < 60; ++i ) {
+    parallel_timeline.step( dt );
+  }
+  parallel_step.stop();
+
+  printTiming( "60 Serial Steps", serial_step.getSeconds() * 1000 );
+  printTiming( "60 Parallel Steps (" + to_string( pool.getWorkerCount() + 1 ) + " threads)", parallel_step.getSeconds() * 1000 );
+  printTiming( "Parallel Speedup (Serial / Parallel)", serial_step.getSeconds() / parallel_step.getSeconds(), "" );
+}
+
+TEST_CASE( "Bucketed Motion Storage Performance" )
+{
+  const size_t count = 50e3;
+  const float dt = 1.0f / 60.0f;
+  printHeading( "Separate and Bucketed Steps for " + to_string( count ) + " Motions" );
+
+  vector<Output<vec2>> separate_targets( count );
+  vector<Output<vec2>> bucketed_targets( count );
+  ch::Timeline separate_timeline;
+  ch::Timeline bucketed_timeline;
+  bucketed_timeline.setMotionStorage( MotionStorage::Bucketed );
+
+  Sequence<vec2> sequence( vec2( 1.0f ) );
+  sequence.then<RampTo>( vec2( 5.0f ), 1.0f, EaseInOutQuad() ).then<RampTo>( vec2( 10.0f, 6.0f ), 0.5f, EaseOutBack() );
+  for( size_t i = 0; i < count; i += 1 ) {
+    separate_timeline.apply( &separate_targets[i], sequence );
+    bucketed_timeline.apply( &bucketed_targets[i], sequence );
+  }
+
+  Timer separate_step( true );
+  for( int i = 0; i < 60; ++i ) {
+    separate_timeline.step( dt );
+  }
+  separate_step.stop();
+
+  Timer bucketed_step( true );
+  for( int i = 0; i < 60; ++i ) {
+    bucketed_timeline.step( dt );
+  }
+  bucketed_step.stop();
+
+  REQUIRE( bucketed_targets.back().value() == separate_targets.back().value() );
+
+  printTiming( "60 Separate Steps", separate_step.getSeconds() * 1000 );
+  printTiming( "60 Bucketed Steps", bucketed_step.getSeconds() * 1000 );
+  printTiming( "Bucketed Speedup (Separate / Bucketed)", separate_step.getSeconds() / bucketed_step.getSeconds(), "" );
+}
+
+TEST_CASE( "Raw Pointer Lookup Performance" )
+{
+  const size_t count = 10e3;
+  printHeading( "Applying and appending raw pointer Motions on " + to_string( count ) + " targets" );
+
+  auto sequence = Sequence<vec2>( vec2( 0 ) )
+    .rampTo( vec2( 10.0f ), 0.5f, EaseInOutQuad() );
+
+  vector<vec2> targets( count );
+  ch::Timeline timeline;
+
+  Timer apply( true );
+  for( auto &target : targets ) {
+    timeline.applyRaw( &target, sequence );
+  }
+  apply.stop();
+
+  Timer append( true );
+  for( auto &target : targets ) {
+    timeline.appendRaw( &target ).hold( 0.5f );
+  }
+  append.stop();
+
+  printTiming( "applyRaw", apply.getSeconds() * 1000 );
+  printTiming( "appendRaw", append.getSeconds() * 1000 );
+}
+
+TEST_CASE( "Pending Cue Performance" )
+{
+  const size_t count = 50e3;
+  const float dt = 1.0f / 60.0f;
+  printHeading( "Stepping " + to_string( count ) + " Cues spread over 100 seconds" );
+
+  ch::Timeline timeline;
+  int calls = 0;
+  for( size_t i = 0; i < count; i += 1 ) {
+    timeline.cue( [&calls] { calls += 1; }, i * (100.0f / count) );
+  }
+
+  Timer first( true );
+  timeline.step( dt );
+  first.stop();
+
+  Timer step( true );
+  for( int i = 0; i < 600; i += 1 ) {
+    timeline.step( dt );
+  }
+  step.stop();
+
+  printTiming( "First step (parks waiting Cues)", first.getSeconds() * 1000 );
+  printTiming( "Average step", step.getSeconds() * 1000 / 600 );
+}
+
+TEST_CASE( "Held Motion Performance" )
+{
+  const size_t count = 50e3;
+  const float dt = 1.0f / 60.0f;
+  printHeading( "Stepping " + to_string( count ) + " Motions through staggered Holds" );
+
+  vector<vec2> held_targets( count );
+  vector<vec2> busy_targets( count );
+  ch::Timeline held;
+  ch::Timeline busy;
+  for( size_t i = 0; i < count; i += 1 )
+  {
+    auto wait = 1.0f + i * (30.0f / count);
+    auto sequence = Sequence<vec2>( vec2( 0 ) )
+      .rampTo( vec2( 1.0f ), 0.1f )
+      .then<Hold>( vec2( 1.0f ), wait )
+      .rampTo( vec2( 10.0f ), 0.5f, EaseOutCubic() );
+    held.applyRaw( &held_targets[i], sequence );
+    // An update function keeps Motions stepping every frame.
+    busy.applyRaw( &busy_targets[i], sequence ).updateFn( [] {} );
+  }
+
+  // Step into the Holds.
+  held.step( 0.2f );
+  busy.step( 0.2f );
+
+  Timer held_timer( true );
+  for( int i = 0; i < 600; i += 1 ) {
+    held.step( dt );
+  }
+  held_timer.stop();
+
+  Timer busy_timer( true );
+  for( int i = 0; i < 600; i += 1 ) {
+    busy.step( dt );
+  }
+  busy_timer.stop();
+
+  printTiming( "Stepped through Holds", busy_timer.getSeconds() * 1000 / 600 );
+  printTiming( "Sleeping through Holds", held_timer.getSeconds() * 1000 / 600 );
+}
+
+TEST_CASE( "Timeline Finish Detection Performance" )
+{
+  const size_t count = 10e3;
+  const float dt = 1.0f / 60.0f;
+  printHeading( "Stepping a Timeline with a finish function and " + to_string( count ) + " nested Motions" );
+
+  auto sequence = Sequence<vec2>( vec2( 0 ) )
+    .rampTo( vec2( 10.0f ), 5.0f, EaseInOutQuad() );
+
+  vector<vec2> targets( count );
+  ch::Timeline timeline;
+  auto group = detail::make_unique<ch::Timeline>();
+  for( auto &target : targets ) {
+    group->applyRaw( &target, sequence );
+  }
+  timeline.add( std::move( group ) );
+  timeline.setFinishFn( [] {} );
+
+  Timer duration( true );
+  for( int i = 0; i < 600; i += 1 ) {
+    timeline.getDuration();
+  }
+  duration.stop();
+
+  Timer step( true );
+  for( int i = 0; i < 60; i += 1 ) {
+    timeline.step( dt );
+  }
+  step.stop();
+
+  printTiming( "Average getDuration()", duration.getSeconds() * 1000 / 600 );
+  printTiming( "Average step", step.getSeconds() * 1000 / 60 );
+}
+
+TEST_CASE( "Cancellation Handle Performance" )
+{
+  const size_t count = 10e3;
+  printHeading( "Creating and cancelling " + to_string( count ) + " Cues through Controls and Handles" );
+
+  ch::Timeline timeline;
+  vector<ScopedCancelRef> controls;
+  vector<ScopedCancelHandle> handles;
+  controls.reserve( count );
+  handles.reserve( count );
+
+  Timer control_timer( true );
+  for( size_t i = 0; i < count; i += 1 ) {
+    controls.push_back( timeline.cue( [] {}, 1.0f ).getScopedControl() );
+  }
+  controls.clear();
+  control_timer.stop();
+  timeline.step( 0.1f );
+
+  Timer handle_timer( true );
+  for( size_t i = 0; i < count; i += 1 ) {
+    handles.push_back( timeline.cue( [] {}, 1.0f ).getScopedHandle() );
+  }
+  handles.clear();
+  handle_timer.stop();
+  timeline.step( 0.1f );
+
+  printTiming( "Scoped Controls", control_timer.getSeconds() * 1000 );
+  printTiming( "Scoped Handles", handle_timer.getSeconds() * 1000 );
+}
+
+TEST_CASE( "Output Pool Upload Performance" )
+{
+  const size_t count = 100e3;
+  printHeading( "Gathering " + to_string( count ) + " animated values for upload" );
+
+  auto sequence = Sequence<vec2>( vec2( 0 ) )
+    .rampTo( vec2( 10.0f ), 1.0f, EaseInOutQuad() );
+
+  vector<Output<vec2>> outputs( count );
+  OutputPool<vec2> pool( count );
+  vector<vec2> upload( count );
+
+  ch::Timeline timeline;
+  for( size_t i = 0; i < count; i += 1 ) {
+    timeline.apply( &outputs[i], sequence );
+    timeline.apply( &pool, i, sequence );
+  }
+  timeline.step( 0.5f );
+
+  Timer gather( true );
+  for( size_t i = 0; i < count; i += 1 ) {
+    upload[i] = outputs[i]();
+  }
+  gather.stop();
+
+  Timer copy( true );
+  std::memcpy( upload.data(), pool.data(), count * sizeof( vec2 ) );
+  copy.stop();
+
+  printTiming( "Gather from Outputs", gather.getSeconds() * 1000 );
+  printTiming( "Copy from OutputPool", copy.getSeconds() * 1000 );
+}
+
+TEST_CASE( "Changed Output Upload Performance" )
+{
+  const size_t count = 100e3;
+  printHeading( "Uploading " + to_string( count ) + " values when one in ten are moving" );
+
+  auto moving = Sequence<vec2>( vec2( 0 ) )
+    .rampTo( vec2( 10.0f ), 1.0f, EaseInOutQuad() );
+  auto holding = Sequence<vec2>( vec2( 0 ) )
+    .then<Hold>( vec2( 0 ), 1.0f );
+
+  OutputPool<vec2> pool( count );
+  vector<vec2> upload( count );
+
+  ch::Timeline timeline;
+  for( size_t i = 0; i < count; i += 1 ) {
+    timeline.apply( &pool, i, ( i % 10 == 0 ) ? moving : holding );
+  }
+  timeline.step( 0.25f );
+  pool.clearChanged();
+  timeline.step( 0.25f );
+
+  Timer full( true );
+  std::memcpy( upload.data(), pool.data(), count * sizeof( vec2 ) );
+  full.stop();
+
+  Timer changed( true );
+  pool.forEachChanged( [&upload, &pool] ( size_t i ) { upload[i] = pool[i]; } );
+  changed.stop();
+
+  printTiming( "Copy whole pool", full.getSeconds() * 1000 );
+  printTiming( "Copy changed elements", changed.getSeconds() * 1000 );
+}
+
+TEST_CASE( "Lazy Evaluation Performance" )
+{
+  const size_t count = 100e3;
+  const size_t visible = count / 20;
+  const float dt = 1.0f / 60.0f;
+  printHeading( "Stepping " + to_string( count ) + " Outputs and reading " + to_string( visible ) );
+
+  auto sequence = Sequence<vec2>( vec2( 0 ) )
+    .rampTo( vec2( 10.0f ), 5.0f, EaseInOutQuad() );
+
+  vector<Output<vec2>> eager_outputs( count );
+  vector<Output<vec2>> lazy_outputs( count );
+  ch::Timeline eager;
+  ch::Timeline lazy;
+  lazy.setLazyEvaluation( true );
+  for( size_t i = 0; i < count; i += 1 ) {
+    eager.apply( &eager_outputs[i], sequence );
+    lazy.apply( &lazy_outputs[i], sequence );
+  }
+
+  vec2 sum( 0 );
+  Timer eager_timer( true );
+  for( int i = 0; i < 60; i += 1 ) {
+    eager.step( dt );
+    for( size_t j = 0; j < visible; j += 1 ) {
+      sum += eager_outputs[j]();
+    }
+  }
+  eager_timer.stop();
+
+  Timer lazy_timer( true );
+  for( int i = 0; i < 60; i += 1 ) {
+    lazy.step( dt );
+    for( size_t j = 0; j < visible; j += 1 ) {
+      sum += lazy_outputs[j]();
+    }
+  }
+  lazy_timer.stop();
+
+  printTiming( "Evaluate while stepping", eager_timer.getSeconds() * 1000 / 60 );
+  printTiming( "Evaluate on read", lazy_timer.getSeconds() * 1000 / 60 );
+  REQUIRE( sum.x > 0 );
+}
+
+TEST_CASE( "Update Rate Performance" )
+{
+  const size_t count = 50e3;
+  const float dt = 1.0f / 60.0f;
+  printHeading( "Stepping " + to_string( count ) + " Motions at 60Hz and at 10Hz" );
+
+  auto sequence = Sequence<vec2>( vec2( 0 ) )
+    .rampTo( vec2( 10.0f ), 20.0f, EaseInOutQuad() );
+
+  vector<vec2> full_targets( count );
+  vector<vec2> background_targets( count );
+  ch::Timeline full;
+  ch::Timeline background;
+  for( size_t i = 0; i < count; i += 1 ) {
+    full.applyRaw( &full_targets[i], sequence );
+    background.applyRaw( &background_targets[i], sequence ).updateRate( 10 );
+  }
+
+  Timer full_timer( true );
+  for( int i = 0; i < 600; i += 1 ) {
+    full.step( dt );
+  }
+  full_timer.stop();
+
+  size_t skipped = 0;
+  Timer background_timer( true );
+  for( int i = 0; i < 600; i += 1 ) {
+    background.step( dt );
+    skipped += background.getSkippedItemCount();
+  }
+  background_timer.stop();
+
+  printTiming( "Every step", full_timer.getSeconds() * 1000 / 600 );
+  printTiming( "10Hz", background_timer.getSeconds() * 1000 / 600 );
+  cout << "Skipped " << skipped / 600 << " Motions per step." << endl;
+}
+
+TEST_CASE( "Time Budget Performance" )
+{
+  const size_t count = 50e3;
+  const float dt = 1.0f / 60.0f;
+  printHeading( "Stepping " + to_string( count ) + " Motions within a 1ms budget" );
+
+  auto sequence = Sequence<vec2>( vec2( 0 ) )
+    .rampTo( vec2( 10.0f ), 20.0f, EaseInOutQuad() );
+
+  vector<vec2> targets( count );
+  ch::Timeline timeline;
+  for( size_t i = 0; i < count; i += 1 ) {
+    timeline.applyRaw( &targets[i], sequence ).priority( i < 1000 ? 1 : 0 );
+  }
+
+  size_t deferred = 0;
+  double overrun = 0;
+  Timer timer( true );
+  for( int i = 0; i < 600; i += 1 ) {
+    timeline.step( dt, Deadline::fromNow( 0.001 ) );
+    deferred += timeline.getBudgetStats().deferred;
+    overrun = std::max( overrun, timeline.getBudgetStats().overrun );
+  }
+  timer.stop();
+
+  printTiming( "Budgeted step", timer.getSeconds() * 1000 / 600 );
+  cout << "Deferred " << deferred / 600 << " Motions per step. Worst overrun " << overrun * 1000 << "ms in "
+       << timeline.getBudgetStats().overrun_steps << " steps." << endl;
+}
+
+TEST_CASE( "Sequence Construction" )
+{
+  const size_t count = 1e6;
+  printHeading( "Building Sequences of " + to_string( count ) + " ramps" );
+
+  vector<vec2> values( count );
+  vector<Time> durations( count, 0.1 );
+  for( size_t i = 0; i < count; i += 1 ) {
+    values[i] = vec2( float( i % 100 ) );
+  }
+
+  Timer then_timer( true );
+  Sequence<vec2> one_by_one( vec2( 0 ) );
+  for( size_t i = 0; i < count; i += 1 ) {
+    one_by_one.then<RampTo>( values[i], durations[i], EaseInOutQuad() );
+  }
+  then_timer.stop();
+
+  Timer bulk_timer( true );
+  Sequence<vec2> bulk( vec2( 0 ) );
+  bulk.reserve( count );
+  bulk.rampsTo( values.data(), durations.data(), count, EaseInOutQuad() );
+  bulk_timer.stop();
+
+  printTiming( "then<RampTo> per phrase", then_timer.getSeconds() * 1000 );
+  printTiming( "rampsTo in bulk", bulk_timer.getSeconds() * 1000 );
+  REQUIRE( bulk.getDuration() == one_by_one.getDuration() );
+}
+
+TEST_CASE( "Compact Sequence Performance" )
+{
+  const size_t count = 100e3;
+  printHeading( "Sequences of " + to_string( count ) + " Phrases stored by pointer and in place" );
+
+  Sequence<vec2>        sequence( vec2( 0 ) );
+  CompactSequence<vec2> compact( vec2( 0 ) );
+  for( size_t i = 0; i < count; i += 1 ) {
+    auto value = vec2( float( i % 100 ) );
+    sequence.then<RampTo>( value, 0.1f, EaseInOutQuad() ).then<Hold>( value, 0.1f );
+    compact.then<RampTo>( value, 0.1f, EaseInOutQuad() ).then<Hold>( value, 0.1f );
+  }
+
+  Timer sequence_copy( true );
+  auto sequence_copied = sequence;
+  sequence_copy.stop();
+  Timer compact_copy( true );
+  auto compact_copied = compact;
+  compact_copy.stop();
+
+  vector<Time> times( count );
+  for( size_t i = 0; i < count; i += 1 ) {
+    times[i] = i * sequence.getDuration() / count;
+  }
+  vector<vec2> values( count );
+
+  Timer sequence_sample( true );
+  sequence_copied.getValues( times.data(), values.data(), count );
+  sequence_sample.stop();
+  Timer compact_sample( true );
+  compact_copied.getValues( times.data(), values.data(), count );
+  compact_sample.stop();
+
+  printTiming( "Sequence copy", sequence_copy.getSeconds() * 1000 );
+  printTiming( "CompactSequence copy", compact_copy.getSeconds() * 1000 );
+  printTiming( "Sequence sampling", sequence_sample.getSeconds() * 1000 );
+  printTiming( "CompactSequence sampling", compact_sample.getSeconds() * 1000 );
+}
+
+TEST_CASE( "Large Sequence Editing" )
+{
+  const size_t count = 100e3;
+  const size_t edits = 1000;
+  printHeading( "Splicing into Sequences of " + to_string( count ) + " Phrases" );
+
+  Sequence<vec2>      sequence( vec2( 0 ) );
+  LargeSequence<vec2> large( vec2( 0 ) );
+  for( size_t i = 0; i < count; i += 1 ) {
+    auto phrase = makeRamp( vec2( float( i ) ), vec2( float( i + 1 ) ), 0.1f );
+    sequence.then( phrase );
+    large.then( phrase );
+  }
+
+  auto replacement = makeRamp( vec2( 0 ), vec2( 1 ), 0.2f );
+  Timer sequence_timer( true );
+  for( size_t i = 0; i < edits; i += 1 ) {
+    sequence.splice( (i * 7919) % count, 1, { replacement, replacement } );
+  }
+  sequence_timer.stop();
+
+  Timer large_timer( true );
+  for( size_t i = 0; i < edits; i += 1 ) {
+    large.splice( (i * 7919) % count, 1, { replacement, replacement } );
+  }
+  large_timer.stop();
+
+  vec2 sum( 0 );
+  Timer lookup_timer( true );
+  for( size_t i = 0; i < edits; i += 1 ) {
+    sum += large.getValue( (i * 7919) % count * 0.1f );
+  }
+  lookup_timer.stop();
+
+  printTiming( "Sequence splice", sequence_timer.getSeconds() * 1000 / edits );
+  printTiming( "LargeSequence splice", large_timer.getSeconds() * 1000 / edits );
+  printTiming( "LargeSequence lookup", lookup_timer.getSeconds() * 1000 / edits );
+  cout << "Checksum " << sum.x << endl;
+}
+
+TEST_CASE( "Staggered Motion Performance" )
+{
+  const size_t count = 10e3;
+  const float dt = 1.0f / 60.0f;
+  printHeading( "Staggering one Sequence over " + to_string( count ) + " targets" );
+
+  auto sequence = Sequence<vec2>( vec2( 0 ) )
+    .rampTo( vec2( 10.0f ), 0.5f, EaseInOutQuad() )
+    .then<Hold>( vec2( 10.0f ), 0.5f )
+    .rampTo( vec2( 0.0f ), 0.5f, EaseOutCubic() );
+
+  vector<vec2> separate_targets( count );
+  vector<vec2> staggered_targets( count );
+
+  ch::Timeline separate;
+  separate.setDefaultRemoveOnFinish( false );
+  Timer create_separate( true );
+  for( size_t i = 0; i < count; i += 1 ) {
+    separate.applyRaw( &separate_targets[i], sequence ).setStartTime( i * 0.0001f );
+  }
+  create_separate.stop();
+
+  ch::Timeline staggered;
+  staggered.setDefaultRemoveOnFinish( false );
+  Timer create_staggered( true );
+  vector<vec2*> targets;
+  for( auto &target : staggered_targets ) {
+    targets.push_back( &target );
+  }
+  staggered.applyStaggered( targets, sequence, [] (size_t i) { return i * 0.0001f; } );
+  create_staggered.stop();
+
+  Timer step_separate( true );
+  for( int i = 0; i < 60; i += 1 ) {
+    separate.step( dt );
+  }
+  step_separate.stop();
+
+  Timer step_staggered( true );
+  for( int i = 0; i < 60; i += 1 ) {
+    staggered.step( dt );
+  }
+  step_staggered.stop();
+
+  printTiming( "Creating Motion per target", create_separate.getSeconds() * 1000 );
+  printTiming( "Creating StaggeredMotion", create_staggered.getSeconds() * 1000 );
+  printTiming( "60 Steps of Motion per target", step_separate.getSeconds() * 1000 );
+  printTiming( "60 Steps of StaggeredMotion", step_staggered.getSeconds() * 1000 );
+  REQUIRE( separate_targets == staggered_targets );
 }
 
 TEST_CASE( "Comparative Performance with cinder::Timeline" )
@@ -83,4 +83,109 @@ TEST_CASE( "Cues" )
       REQUIRE( call_count == 1 );
     }
   }
+
+  SECTION( "Waiting cues are called on time and in order." )
+  {
+    vector<int>   calls;
+    vector<Time>  call_times;
+    for( int i = 0; i < 500; i += 1 ) {
+      timeline.cue( [&, i] { calls.push_back( i ); call_times.push_back( timeline.time() ); }, 2.0 + (i / 2) * 0.01 );
+    }
+    REQUIRE( timeline.size() == 501 );
+
+    timeline.step( 1.0 );
+    REQUIRE( call_count == 1 );
+    REQUIRE( calls.empty() );
+    REQUIRE( timeline.size() == 500 );
+
+    while( ! timeline.empty() ) {
+      timeline.step( 0.05 );
+    }
+
+    REQUIRE( calls.size() == 500 );
+    REQUIRE( std::is_sorted( calls.begin(), calls.end() ) );
+    bool on_time = true;
+    for( size_t i = 0; i < calls.size(); i += 1 ) {
+      auto delay = 2.0 + (i / 2) * 0.01;
+      on_time = on_time && call_times[i] >= delay - 1.0e-9 && call_times[i] < delay + 0.05;
+    }
+    REQUIRE( on_time );
+  }
+
+  SECTION( "Waiting cues can be cancelled and delayed." )
+  {
+    auto later = timeline.cue( [&call_count] { call_count += 10; }, 5.0f ).getControl();
+    timeline.step( 0.5f );
+    REQUIRE( timeline.size() == 2 );
+
+    later->cancel();
+    timeline.step( 0.1f );
+    REQUIRE( timeline.size() == 1 );
+
+    options.setStartTime( 2.0f );
+    timeline.step( 1.0f );
+    REQUIRE( call_count == 0 );
+    timeline.step( 0.5f );
+    REQUIRE( call_count == 1 );
+    REQUIRE( timeline.empty() );
+  }
+
+  SECTION( "Rewinding the Timeline rewinds waiting cues." )
+  {
+    options.removeOnFinish( false );
+    timeline.step( 0.5f );
+    timeline.setTime( 0.0f );
+    timeline.step( 0.75f );
+    REQUIRE( call_count == 0 );
+    timeline.step( 0.25f );
+    REQUIRE( call_count == 1 );
+  }
+
+  SECTION( "Cues can be cancelled by generational Handle." )
+  {
+    auto handle = options.getHandle();
+    auto copy = handle;
+    REQUIRE( copy.isValid() );
+
+    copy.cancel();
+    REQUIRE( handle.isInvalid() );
+    timeline.jumpTo( 1.0f );
+    REQUIRE( call_count == 0 );
+    REQUIRE( timeline.empty() );
+  }
+
+  SECTION( "Handles to removed items stay invalid when their slot is reused." )
+  {
+    auto handle = options.getHandle();
+    timeline.jumpTo( 1.0f );
+    REQUIRE( call_count == 1 );
+    REQUIRE( handle.isInvalid() );
+
+    auto next = timeline.cue( [&call_count] { call_count += 1; }, 1.0f ).getHandle();
+    REQUIRE( next.isValid() );
+    handle.cancel();
+    REQUIRE( next.isValid() );
+  }
+
+  SECTION( "Scoped Handles cancel on destruction." )
+  {
+    {
+      auto scoped = options.getScopedHandle();
+      REQUIRE( scoped.getHandle().isValid() );
+    }
+    timeline.jumpTo( 1.0f );
+    REQUIRE( call_count == 0 );
+  }
+
+  SECTION( "Handles outlive their Timeline." )
+  {
+    TimelineItemHandle handle;
+    {
+      Timeline other;
+      handle = other.cue( [] {}, 1.0f ).getHandle();
+      REQUIRE( handle.isValid() );
+    }
+    REQUIRE( handle.isInvalid() );
+    handle.cancel();
+  }
 }
@@ -80,3 +80,98 @@ TEST_CASE( "Separate component interpolation", "[sequence]" )
 } // Separate Component Easing
 
 #endif
+
+namespace {
+
+/// Returns the largest difference between batch and scalar evaluation of \a ease over [0, 1].
+template<typename EaseT>
+float maxBatchError( EaseT ease )
+{
+  std::vector<float> times;
+  for( int i = 0; i <= 101; i += 1 ) {
+    times.push_back( i / 101.0f );
+  }
+  times.push_back( 0.5f );
+
+  std::vector<float> results( times.size() );
+  choreograph::easeBatch( ease, times.data(), results.data(), times.size() );
+
+  float error = 0.0f;
+  for( size_t i = 0; i < times.size(); i += 1 ) {
+    error = std::max( error, std::abs( results[i] - ease( times[i] ) ) );
+  }
+  return error;
+}
+
+} // namespace
+
+TEST_CASE( "Batch Easing" )
+{
+  using namespace choreograph;
+  const float tolerance = BatchEaseTolerance;
+
+  SECTION( "Polynomial batch eases match their scalar versions." )
+  {
+    REQUIRE( maxBatchError( EaseNone() ) == 0.0f );
+    REQUIRE( maxBatchError( EaseInQuad() ) < tolerance );
+    REQUIRE( maxBatchError( EaseOutQuad() ) < tolerance );
+    REQUIRE( maxBatchError( EaseInOutQuad() ) < tolerance );
+    REQUIRE( maxBatchError( EaseOutInQuad() ) < tolerance );
+    REQUIRE( maxBatchError( EaseInCubic() ) < tolerance );
+    REQUIRE( maxBatchError( EaseOutCubic() ) < tolerance );
+    REQUIRE( maxBatchError( EaseInOutCubic() ) < tolerance );
+    REQUIRE( maxBatchError( EaseOutInCubic() ) < tolerance );
+    REQUIRE( maxBatchError( EaseInQuart() ) < tolerance );
+    REQUIRE( maxBatchError( EaseOutQuart() ) < tolerance );
+    REQUIRE( maxBatchError( EaseInOutQuart() ) < tolerance );
+    REQUIRE( maxBatchError( EaseOutInQuart() ) < tolerance );
+    REQUIRE( maxBatchError( EaseInQuint() ) < tolerance );
+    REQUIRE( maxBatchError( EaseOutQuint() ) < tolerance );
+    REQUIRE( maxBatchError( EaseInOutQuint() ) < tolerance );
+    REQUIRE( maxBatchError( EaseOutInQuint() ) < tolerance );
+    REQUIRE( maxBatchError( EaseInCirc() ) < tolerance );
+    REQUIRE( maxBatchError( EaseOutCirc() ) < tolerance );
+    REQUIRE( maxBatchError( EaseInOutCirc() ) < tolerance );
+    REQUIRE( maxBatchError( EaseOutInCirc() ) < tolerance );
+    REQUIRE( maxBatchError( EaseInBack() ) < tolerance );
+    REQUIRE( maxBatchError( EaseOutBack() ) < tolerance );
+    REQUIRE( maxBatchError( EaseInOutBack() ) < tolerance );
+    REQUIRE( maxBatchError( EaseOutInBack() ) < tolerance );
+    REQUIRE( maxBatchError( EaseInBounce() ) < tolerance );
+    REQUIRE( maxBatchError( EaseOutBounce() ) < tolerance );
+    REQUIRE( maxBatchError( EaseInOutBounce() ) < tolerance );
+    REQUIRE( maxBatchError( EaseOutInBounce() ) < tolerance );
+  }
+
+  SECTION( "Transcendental batch eases approximate their scalar versions." )
+  {
+    REQUIRE( maxBatchError( EaseInSine() ) < tolerance );
+    REQUIRE( maxBatchError( EaseOutSine() ) < tolerance );
+    REQUIRE( maxBatchError( EaseInOutSine() ) < tolerance );
+    REQUIRE( maxBatchError( EaseOutInSine() ) < tolerance );
+    REQUIRE( maxBatchError( EaseInExpo() ) < tolerance );
+    REQUIRE( maxBatchError( EaseOutExpo() ) < tolerance );
+    REQUIRE( maxBatchError( EaseInOutExpo() ) < tolerance );
+    REQUIRE( maxBatchError( EaseOutInExpo() ) < tolerance );
+    REQUIRE( maxBatchError( EaseInElastic( 1.0f, 0.3f ) ) < tolerance );
+    REQUIRE( maxBatchError( EaseOutElastic( 1.0f, 0.3f ) ) < tolerance );
+    REQUIRE( maxBatchError( EaseInOutElastic( 2.0f, 0.45f ) ) < tolerance );
+    REQUIRE( maxBatchError( EaseOutInElastic( 1.0f, 0.3f ) ) < tolerance );
+    REQUIRE( maxBatchError( EaseInAtan() ) < tolerance );
+    REQUIRE( maxBatchError( EaseOutAtan() ) < tolerance );
+    REQUIRE( maxBatchError( EaseInOutAtan() ) < tolerance );
+  }
+
+  SECTION( "Eases without a batch kernel are called once per time." )
+  {
+    REQUIRE( ! hasBatchKernel<float (*)( float )>() );
+    REQUIRE( hasBatchKernel<EaseInOutQuad>() );
+
+    int calls = 0;
+    auto counting = [&calls] ( float t ) { calls += 1; return t * 2.0f; };
+    float values[] = { 0.0f, 0.25f, 0.5f };
+    easeBatch( counting, values, values, 3 );
+    REQUIRE( calls == 3 );
+    REQUIRE( values[2] == 1.0f );
+  }
+}
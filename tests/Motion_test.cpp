@@ -7,6 +7,7 @@
 
 #include "catch.hpp"
 #include "choreograph/Choreograph.h"
+#include <stdexcept>
 
 using namespace choreograph;
 using namespace std;
@@ -35,6 +36,45 @@ TEST_CASE( "Motions" )
       REQUIRE( target() == sequence.getValue( t ) );
     }
   }
+
+  SECTION( "Motions stepped forward and backward match their Sequence." )
+  {
+    bool all_match = true;
+    for( int i = 0; i < 40; i += 1 ) {
+      motion.step( 0.1 );
+      all_match = all_match && (target() == sequence.getValue( motion.time() ));
+    }
+    motion.setPlaybackSpeed( -1.0 );
+    for( int i = 0; i < 40; i += 1 ) {
+      motion.step( 0.1 );
+      all_match = all_match && (target() == sequence.getValue( motion.time() ));
+    }
+    REQUIRE( all_match );
+  }
+
+  SECTION( "Inflection callbacks fire once per crossing in either direction." )
+  {
+    int crossings = 0;
+    motion.addInflectionCallback( 2, [&crossings] { crossings += 1; } );
+    for( int i = 0; i < 40; i += 1 ) {
+      motion.step( 0.1 );
+    }
+    REQUIRE( crossings == 1 );
+    motion.setPlaybackSpeed( -1.0 );
+    for( int i = 0; i < 40; i += 1 ) {
+      motion.step( 0.1 );
+    }
+    REQUIRE( crossings == 2 );
+
+    // After slicing, the Motion's first phrase is the original second phrase.
+    motion.setPlaybackSpeed( 1.0 );
+    motion.jumpTo( 1.5 );
+    motion.cutPhrasesBefore( 1.0 );
+    REQUIRE( motion.getDuration() == 2 );
+    motion.step( 1.0 );
+    REQUIRE( target() == sequence.getValue( 2.5 ) );
+    REQUIRE( crossings == 3 );
+  }
 }
 
 TEST_CASE( "Outputs" )
@@ -138,3 +178,109 @@ TEST_CASE( "Outputs" )
     REQUIRE( copy.value() == 10.0f );
   }
 } // Outputs
+
+TEST_CASE( "Staggered Motions" )
+{
+  auto sequence = Sequence<float>( 0.0f )
+    .then<RampTo>( 10.0f, 1.0f, EaseInOutQuad() )
+    .then<Hold>( 10.0f, 0.5f )
+    .then<RampTo>( 5.0f, 1.0f );
+
+  const size_t count = 200;
+  vector<float> staggered( count, -1.0f );
+  vector<float> separate( count, -1.0f );
+
+  SECTION( "Staggered Motions match a delayed Motion per target." )
+  {
+    ch::Timeline timeline;
+    vector<float*> targets;
+    for( auto &value : staggered ) {
+      targets.push_back( &value );
+    }
+
+    int finishes = 0;
+    timeline.applyStaggered( targets, sequence, [] (size_t i) { return i * 0.01; } )
+      .finishFn( [&finishes] { finishes += 1; } );
+
+    for( size_t i = 0; i < count; i += 1 ) {
+      timeline.applyRaw( &separate[i], sequence ).setStartTime( i * 0.01 );
+    }
+
+    bool all_match = true;
+    for( int frame = 0; frame < 300; frame += 1 ) {
+      timeline.step( 1.0 / 60.0 );
+      all_match = all_match && (staggered == separate);
+    }
+    REQUIRE( all_match );
+    REQUIRE( finishes == 1 );
+    REQUIRE( timeline.empty() );
+  }
+
+  SECTION( "Staggered Motions can animate contiguous values." )
+  {
+    StaggeredMotion<float> motion( sequence, staggered.data(), count, 0.1 );
+    REQUIRE( motion.getDuration() == Approx( sequence.getDuration() + (count - 1) * 0.1 ) );
+
+    motion.jumpTo( 0.5 );
+    REQUIRE( staggered[0] == sequence.getValue( 0.5 ) );
+    REQUIRE( staggered[3] == sequence.getValue( 0.2 ) );
+    REQUIRE( staggered[10] == sequence.getStartValue() );
+
+    motion.jumpTo( motion.getDuration() );
+    REQUIRE( staggered.back() == sequence.getEndValue() );
+  }
+
+  SECTION( "Staggered Motions report the targets they change." )
+  {
+    ch::Timeline timeline;
+    timeline.setChangeTracking( true );
+    OutputPool<float> pool( 4, 0.0f );
+    timeline.applyStaggered( { &pool[0], &pool[1], &pool[2], &pool[3] }, sequence, { 0.0, 0.5, 1.0, 10.0 } );
+
+    timeline.step( 0.75 );
+    // The last two targets are still waiting at the start value.
+    REQUIRE( timeline.getChangedTargets() == vector<const void*>( { &pool[0], &pool[1] } ) );
+
+    timeline.step( 0.5 );
+    REQUIRE( timeline.getChangedTargets().size() == 3 );
+
+    // The first target is holding.
+    timeline.step( 0.25 );
+    REQUIRE( timeline.getChangedTargets() == vector<const void*>( { &pool[1], &pool[2] } ) );
+  }
+
+  SECTION( "Staggered Motions can replace their Sequence." )
+  {
+    StaggeredMotion<float> motion( sequence, staggered.data(), count, 0.1 );
+    auto replacement = Sequence<float>( 5.0f ).then<RampTo>( 15.0f, 4.0f );
+    motion.setSequence( replacement );
+    REQUIRE( motion.getSequence().getDuration() == 4.0 );
+    REQUIRE( motion.getDuration() == Approx( 4.0 + (count - 1) * 0.1 ) );
+
+    motion.jumpTo( 2.0 );
+    REQUIRE( staggered[0] == replacement.getValue( 2.0 ) );
+    REQUIRE( staggered[10] == replacement.getValue( 1.0 ) );
+    REQUIRE( staggered[30] == 5.0f );
+  }
+
+  SECTION( "Staggered Motions need an offset for every target." )
+  {
+    ch::Timeline timeline;
+    vector<float*> targets = { &staggered[0], &staggered[1] };
+    int invalid_count = 0;
+    try {
+      timeline.applyStaggered( targets, sequence, { 0.0 } );
+    }
+    catch( const std::invalid_argument & ) {
+      invalid_count += 1;
+    }
+    try {
+      StaggeredMotion<float> motion( sequence, targets, { 0.0, 0.5, 1.0 } );
+    }
+    catch( const std::invalid_argument & ) {
+      invalid_count += 1;
+    }
+    REQUIRE( invalid_count == 2 );
+    REQUIRE( timeline.empty() );
+  }
+}
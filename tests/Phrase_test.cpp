@@ -119,4 +119,57 @@ TEST_CASE( "Phrases" )
     REQUIRE( ramp_bc->getValue( 1.0f ).name == "target" );
     REQUIRE( mix_ramps->getValue( 0.5f ).y == ((550.0f * 0.5f) + (55.0f * 0.5f)) );
   }
+
+  SECTION( "Static ramps match dynamic ramps." )
+  {
+    auto dynamic_ramp = makeRamp( 1.0f, 10.0f, 1.0f, EaseInOutQuad() );
+    auto static_ramp = make_shared<StaticRampTo<float, EaseInOutQuad>>( 1.0f, 1.0f, 10.0f );
+    auto pointer_ramp = make_shared<StaticRampTo<float, float (*)( float )>>( 1.0f, 1.0f, 10.0f, &easeInOutQuad );
+
+    for( Time t = 0; t <= 1.0; t += 0.125 ) {
+      REQUIRE( static_ramp->getValue( t ) == dynamic_ramp->getValue( t ) );
+      REQUIRE( pointer_ramp->getValue( t ) == dynamic_ramp->getValue( t ) );
+    }
+
+    auto sequence = Sequence<float>( 1.0f )
+      .rampTo( 10.0f, 1.0f, EaseInOutQuad() )
+      .rampTo( 20.0f, 1.0f )
+      .rampTo( 30.0f, 1.0f, easeInQuad );
+    using QuadRamp = StaticRampTo<float, EaseInOutQuad>;
+    REQUIRE( dynamic_pointer_cast<QuadRamp>( sequence.getPhraseAtIndex( 0 ) ) );
+    REQUIRE( sequence.getValue( 0.5 ) == dynamic_ramp->getValue( 0.5 ) );
+    REQUIRE( sequence.getValue( 1.5 ) == 15.0f );
+    REQUIRE( sequence.getValue( 2.5 ) == 20.0f + 10.0f * easeInQuad( 0.5f ) );
+  }
+
+  SECTION( "Batched values from static ramps are within BatchEaseTolerance of getValue()." )
+  {
+    auto sine_ramp = make_shared<StaticRampTo<float, EaseInOutSine>>( 1.0f, 0.0f, 1.0f );
+    auto expo_ramp = make_shared<StaticRampTo<float, EaseOutExpo>>( 1.0f, 0.0f, 1.0f );
+    auto dynamic_ramp = makeRamp( 0.0f, 1.0f, 1.0f, EaseInOutSine() );
+
+    vector<Time> times;
+    for( Time t = 0; t <= 1.0; t += 1.0 / 64 ) {
+      times.push_back( t );
+    }
+    vector<float> sine( times.size() );
+    vector<float> expo( times.size() );
+    vector<float> dynamic( times.size() );
+    sine_ramp->getValues( times.data(), sine.data(), times.size() );
+    expo_ramp->getValues( times.data(), expo.data(), times.size() );
+    dynamic_ramp->getValues( times.data(), dynamic.data(), times.size() );
+
+    float sine_error = 0;
+    float expo_error = 0;
+    bool dynamic_exact = true;
+    for( size_t i = 0; i < times.size(); i += 1 ) {
+      sine_error = std::max( sine_error, std::abs( sine[i] - sine_ramp->getValue( times[i] ) ) );
+      expo_error = std::max( expo_error, std::abs( expo[i] - expo_ramp->getValue( times[i] ) ) );
+      dynamic_exact = dynamic_exact && dynamic[i] == dynamic_ramp->getValue( times[i] );
+    }
+    REQUIRE( sine_error <= BatchEaseTolerance );
+    REQUIRE( expo_error <= BatchEaseTolerance );
+    // Ramps without a batch kernel call the same ease function either way.
+    REQUIRE( dynamic_exact );
+  }
 }
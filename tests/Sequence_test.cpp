@@ -7,6 +7,7 @@
 
 #include "catch.hpp"
 #include "choreograph/Choreograph.h"
+#include <stdexcept>
 
 using namespace choreograph;
 using namespace std;
@@ -107,6 +108,27 @@ TEST_CASE( "Sequences" )
     REQUIRE( sequence.getPhraseAtIndex( 1 ) == sequence.getPhraseAtIndex( 2 ) );
   }
 
+  SECTION( "Ramps can be appended in bulk." )
+  {
+    const float values[] = { 5.0f, 2.0f, 8.0f };
+    const Time durations[] = { 1.0, 0.5, 2.0 };
+    auto expected = sequence;
+    expected.rampTo( 5.0f, 1.0f ).rampTo( 2.0f, 0.5f ).rampTo( 8.0f, 2.0f );
+    sequence.reserve( 6 );
+    sequence.rampsTo( values, durations, 3 );
+
+    REQUIRE( sequence.size() == 6 );
+    REQUIRE( sequence.getDuration() == expected.getDuration() );
+    for( Time t = 0; t <= 7.0; t += 0.25 ) {
+      REQUIRE( sequence.getValue( t ) == expected.getValue( t ) );
+    }
+
+    // The ramps outlive the Sequence that created them.
+    auto ramp = sequence.getPhraseAtIndex( 4 );
+    sequence.splice( 3, 3, {} );
+    REQUIRE( ramp->getEndValue() == 2.0f );
+  }
+
   SECTION( "Sequences prevent incorrect splicing." )
   {
     sequence.splice( 100, 100, {} );
@@ -117,6 +139,344 @@ TEST_CASE( "Sequences" )
   }
 }
 
+TEST_CASE( "Sequence Phrase Lookup" )
+{
+  // Phrases of uneven length, including instantaneous ones.
+  auto sequence = Sequence<float>( 0.0f );
+  vector<Time> durations;
+  for( int i = 0; i < 200; i += 1 ) {
+    Time duration = (i % 7 == 3) ? 0 : (0.25 + (i % 5) * 0.5);
+    durations.push_back( duration );
+    sequence.then<RampTo>( (float)i, duration );
+  }
+
+  // Reference linear walk over phrase durations.
+  auto phrase_at = [&durations] ( Time t ) {
+    for( size_t i = 0; i < durations.size(); i += 1 ) {
+      if( durations[i] < t ) {
+        t -= durations[i];
+      }
+      else {
+        return i;
+      }
+    }
+    return durations.size() - 1;
+  };
+
+  SECTION( "Binary search finds the same phrase as a linear walk." )
+  {
+    bool all_match = true;
+    for( Time t = 0; t < sequence.getDuration(); t += 0.125 ) {
+      auto points = sequence.getInflectionPoints( t, t );
+      if( points.first != phrase_at( t ) || sequence.getPhraseAtTime( t ) != sequence.getPhraseAtIndex( phrase_at( t ) ) ) {
+        all_match = false;
+      }
+    }
+    REQUIRE( all_match );
+  }
+
+  SECTION( "Phrase start times are kept up to date." )
+  {
+    REQUIRE( sequence.getDuration() == Approx( sequence.calcDuration() ) );
+    REQUIRE( sequence.getTimeAtInflection( 3 ) == durations[0] + durations[1] + durations[2] );
+
+    sequence.splice( 10, 20, { makeRamp( 1.0f, 2.0f, 100.0 ) } );
+    REQUIRE( sequence.getDuration() == Approx( sequence.calcDuration() ) );
+    REQUIRE( sequence.getPhraseAtTime( sequence.getTimeAtInflection( 10 ) + 50.0 ) == sequence.getPhraseAtIndex( 10 ) );
+
+    auto copy = sequence;
+    sequence.then( copy ).set( 5.0f );
+    REQUIRE( sequence.getDuration() == Approx( sequence.calcDuration() ) );
+    REQUIRE( sequence.getValue( copy.getDuration() + 1.0 ) == copy.getValue( 1.0 ) );
+    REQUIRE( sequence.getEndValue() == 5.0f );
+  }
+
+  SECTION( "Cursors find the same phrase as a full search, in any order." )
+  {
+    SequenceCursor cursor;
+    bool all_match = true;
+    for( Time t = -1; t < sequence.getDuration() + 1; t += 0.0625 ) {
+      if( sequence.seek( t, cursor ) != sequence.getInflectionPoints( t, t ).first || sequence.getValue( t, cursor ) != sequence.getValue( t ) ) {
+        all_match = false;
+      }
+    }
+    for( Time t = sequence.getDuration() + 1; t > -1; t -= 0.0625 ) {
+      if( sequence.seek( t, cursor ) != sequence.getInflectionPoints( t, t ).first || sequence.getValue( t, cursor ) != sequence.getValue( t ) ) {
+        all_match = false;
+      }
+    }
+    for( int i = 0; i < 1000; i += 1 ) {
+      Time t = std::fmod( i * 37.3, sequence.getDuration() );
+      if( sequence.seek( t, cursor ) != sequence.getInflectionPoints( t, t ).first ) {
+        all_match = false;
+      }
+    }
+    REQUIRE( all_match );
+
+    // Cursors past the end of a shortened Sequence still work.
+    cursor.index = sequence.size() - 1;
+    sequence.splice( 10, sequence.size() - 10, {} );
+    REQUIRE( sequence.seek( 0.0, cursor ) == 0 );
+    REQUIRE( sequence.seek( sequence.getDuration(), cursor ) == sequence.size() - 1 );
+  }
+
+  SECTION( "Times past the end of the Sequence belong to the last Phrase." )
+  {
+    auto points = sequence.getInflectionPoints( sequence.getDuration() + 1, sequence.getDuration() + 2 );
+    REQUIRE( points.first == sequence.size() - 1 );
+    REQUIRE( points.second == sequence.size() - 1 );
+  }
+
+  SECTION( "Holds report the span over which the Sequence value is constant." )
+  {
+    auto held = Sequence<float>( 0.0f )
+      .then<RampTo>( 1.0f, 1.0f )
+      .then<Hold>( 1.0f, 2.0f )
+      .then<RampTo>( 2.0f, 1.0f );
+    SequenceCursor cursor;
+    Time begin, end;
+
+    REQUIRE( ! held.getConstantSpan( 0.5, cursor, &begin, &end ) );
+    REQUIRE( held.getConstantSpan( 2.0, cursor, &begin, &end ) );
+    REQUIRE( begin == 1.0 );
+    REQUIRE( end == 3.0 );
+    REQUIRE( held.getConstantSpan( 5.0, cursor, &begin, &end ) );
+    REQUIRE( begin == 4.0 );
+
+    // Slicing wraps the Hold in a ClipPhrase, which keeps the span within the clip.
+    auto sliced = held.slice( 1.5, 4.0 );
+    REQUIRE( sliced.getConstantSpan( 1.0, cursor, &begin, &end ) );
+    REQUIRE( begin == 0.0 );
+    REQUIRE( end == 1.5 );
+  }
+}
+
+TEST_CASE( "Sequence Sampling" )
+{
+  auto inner = Sequence<float>( 0.0f ).then<RampTo>( 5.0f, 0.5f ).then<Hold>( 5.0f, 0.25f );
+  auto sequence = Sequence<float>( 1.0f )
+    .then<RampTo>( 10.0f, 1.0f, EaseInOutQuad() )
+    .then<Hold>( 3.0f, 0.5f )
+    .set( 20.0f )
+    .rampTo( 30.0f, 2.0f, EaseOutCubic() )
+    .rampTo( 0.0f, 1.5f, EaseInOutSine() )
+    .then( makeRamp( 0.0f, 100.0f, 0.0f ) )
+    .then( make_shared<SequencePhrase<float>>( inner ) );
+
+  auto matches = [&sequence] ( const vector<Time> &times, const vector<float> &values ) {
+    for( size_t i = 0; i < times.size(); i += 1 ) {
+      if( values[i] != Approx( sequence.getValue( times[i] ) ).epsilon( BatchEaseTolerance ) ) {
+        return false;
+      }
+    }
+    return true;
+  };
+
+  SECTION( "Batch evaluation matches individual evaluation." )
+  {
+    vector<Time> times;
+    for( Time t = -1.0; t < sequence.getDuration() + 1.0; t += 0.01 ) {
+      times.push_back( t );
+    }
+    times.push_back( 1.0 );
+    times.push_back( 1.5 );
+    times.push_back( 3.5 );
+
+    vector<float> values( times.size() );
+    sequence.getValues( times.data(), values.data(), times.size() );
+    REQUIRE( matches( times, values ) );
+
+    std::reverse( times.begin(), times.end() );
+    sequence.getValues( times.data(), values.data(), times.size() );
+    REQUIRE( matches( times, values ) );
+  }
+
+  SECTION( "Sampling evaluates evenly spaced times." )
+  {
+    const size_t count = 1000;
+    const Time step = sequence.getDuration() / (count - 1);
+    vector<float> values( count );
+    sequence.sample( 0.0, step, count, values.data() );
+
+    vector<Time> times;
+    for( size_t i = 0; i < count; i += 1 ) {
+      times.push_back( i * step );
+    }
+    REQUIRE( matches( times, values ) );
+    REQUIRE( values.front() == 1.0f );
+    REQUIRE( values.back() == sequence.getEndValue() );
+  }
+
+  SECTION( "Phrases can be sampled directly." )
+  {
+    auto ramp = makeRamp( 0.0f, 10.0f, 2.0f );
+    vector<float> values( 5 );
+    ramp->sample( 0.0, 0.5, values.size(), values.data() );
+    REQUIRE( values == vector<float>( { 0.0f, 2.5f, 5.0f, 7.5f, 10.0f } ) );
+  }
+}
+
+TEST_CASE( "Large Sequences" )
+{
+  // Durations are multiples of a quarter, so sums are exact and both Sequences agree on every boundary.
+  auto phrase = [] ( int i ) { return makeRamp( float( i ), float( i + 1 ), 0.25f * (1 + i % 4) ); };
+
+  SECTION( "Edits and lookups match Sequence." )
+  {
+    Sequence<float>       sequence( 0.0f );
+    LargeSequence<float>  large( 0.0f );
+    for( int i = 0; i < 200; i += 1 ) {
+      auto p = phrase( i );
+      sequence.then( p );
+      large.then( p );
+    }
+
+    uint32_t seed = 7;
+    auto random = [&seed] ( size_t n ) { seed = seed * 1664525 + 1013904223; return (seed >> 8) % n; };
+    for( int edit = 0; edit < 100; edit += 1 )
+    {
+      auto index = random( sequence.size() );
+      auto removed = random( 3 );
+      vector<PhraseRef<float>> inserted;
+      for( size_t i = random( 4 ); i > 0; i -= 1 ) {
+        inserted.push_back( phrase( int( random( 1000 ) ) ) );
+      }
+      removed = std::min( removed, sequence.size() - index );
+      sequence.splice( index, removed, inserted );
+      large.splice( index, removed, inserted );
+      if( sequence.size() > 1 ) {
+        auto replaced = random( sequence.size() );
+        auto replacement = phrase( edit );
+        sequence.replacePhraseAtIndex( replaced, replacement );
+        large.replacePhraseAtIndex( replaced, replacement );
+      }
+    }
+
+    REQUIRE( large.size() == sequence.size() );
+    REQUIRE( large.getDuration() == sequence.getDuration() );
+    REQUIRE( large.getEndValue() == sequence.getEndValue() );
+    for( size_t i = 0; i < large.size(); i += 1 ) {
+      REQUIRE( large.getPhraseAtIndex( i ) == sequence.getPhraseAtIndex( i ) );
+      REQUIRE( large.getPhraseStartTime( i ) == sequence.getTimeAtInflection( i ) );
+    }
+    for( Time t = -0.5; t <= sequence.getDuration() + 0.5; t += 0.125 ) {
+      REQUIRE( large.getPhraseIndexAtTime( t ) == sequence.getInflectionPoints( t, t ).first );
+      REQUIRE( large.getValue( t ) == sequence.getValue( t ) );
+    }
+
+    auto converted = large.toSequence();
+    REQUIRE( converted.size() == sequence.size() );
+    REQUIRE( converted.getValue( 10.0 ) == sequence.getValue( 10.0 ) );
+  }
+
+  SECTION( "Empty LargeSequences hold their initial value." )
+  {
+    LargeSequence<float> large( 5.0f );
+    REQUIRE( large.empty() );
+    REQUIRE( large.getValue( 1.0 ) == 5.0f );
+    REQUIRE( large.getDuration() == 0 );
+
+    large.then<RampTo>( 10.0f, 1.0f ).then<Hold>( 10.0f, 1.0f );
+    REQUIRE( large.getValue( 0.5 ) == 7.5f );
+    large.erase( 0, 10 );
+    REQUIRE( large.empty() );
+
+    bool threw_out_of_range = false;
+    try {
+      large.getPhraseAtIndex( 0 );
+    }
+    catch( const std::out_of_range & ) {
+      threw_out_of_range = true;
+    }
+    REQUIRE( threw_out_of_range );
+  }
+}
+
+TEST_CASE( "Compact Sequences" )
+{
+  auto shared = makeRamp( 8.0f, 2.0f, 1.0f );
+  auto sequence = Sequence<float>( 0.0f )
+    .then<RampTo>( 10.0f, 1.0f, EaseInOutQuad() )
+    .then<Hold>( 10.0f, 0.5f )
+    .rampTo( 4.0f, 1.0f, EaseOutCubic() )
+    .then( shared );
+  auto compact = CompactSequence<float>( 0.0f )
+    .then<RampTo>( 10.0f, 1.0f, EaseInOutQuad() )
+    .then<Hold>( 10.0f, 0.5f )
+    .rampTo( 4.0f, 1.0f, EaseOutCubic() )
+    .then( shared );
+
+  SECTION( "Built-in Phrases are stored in place and evaluate like a Sequence." )
+  {
+    REQUIRE( compact.size() == 4 );
+    REQUIRE( compact.isPhraseInline( 0 ) );
+    REQUIRE( compact.isPhraseInline( 1 ) );
+    REQUIRE( compact.isPhraseInline( 2 ) );
+    REQUIRE_FALSE( compact.isPhraseInline( 3 ) );
+    REQUIRE( &compact.getPhraseAtIndex( 3 ) == shared.get() );
+
+    REQUIRE( compact.getDuration() == sequence.getDuration() );
+    vector<Time> times;
+    for( Time t = -0.5; t < 4.0; t += 0.1 ) {
+      times.push_back( t );
+      REQUIRE( compact.getValue( t ) == sequence.getValue( t ) );
+    }
+    vector<float> values( times.size() );
+    vector<float> expected( times.size() );
+    compact.getValues( times.data(), values.data(), times.size() );
+    sequence.getValues( times.data(), expected.data(), times.size() );
+    REQUIRE( values == expected );
+
+    SequenceCursor cursor;
+    Time begin, end;
+    REQUIRE( compact.getConstantSpan( 1.25, cursor, &begin, &end ) );
+    REQUIRE( begin == 1.0 );
+    REQUIRE( end == 1.5 );
+  }
+
+  SECTION( "Copies own their Phrases." )
+  {
+    auto copy = compact;
+    copy.then<RampTo>( 0.0f, 1.0f );
+    REQUIRE( &copy.getPhraseAtIndex( 0 ) != &compact.getPhraseAtIndex( 0 ) );
+    REQUIRE( copy.getValue( 0.5 ) == compact.getValue( 0.5 ) );
+    REQUIRE( compact.size() == 4 );
+  }
+
+  SECTION( "Growing a Compact Sequence moves its Phrases instead of copying them." )
+  {
+    struct CountingLerp
+    {
+      explicit CountingLerp( int *copies ): copies( copies ) {}
+      CountingLerp( const CountingLerp &rhs ): copies( rhs.copies ) { *copies += 1; }
+      CountingLerp( CountingLerp &&rhs ) noexcept = default;
+      float operator() ( float a, float b, float t ) const { return a + (b - a) * t; }
+      int *copies;
+    };
+
+    int copies = 0;
+    auto counted = CompactSequence<float>( 0.0f );
+    for( int i = 0; i < 8; i += 1 ) {
+      counted.rampTo( i * 1.0f, 1.0f, EaseNone(), CountingLerp( &copies ) );
+    }
+    REQUIRE( counted.isPhraseInline( 0 ) );
+
+    const auto before = copies;
+    counted.reserve( 1000 );
+    REQUIRE( copies == before );
+    REQUIRE( counted.getValue( 7.5 ) == 6.5f );
+  }
+
+  SECTION( "Compact Sequences play on Timelines as a single Phrase." )
+  {
+    Timeline timeline;
+    Output<float> output;
+    timeline.apply( &output, Sequence<float>( compact.asPhrase() ) );
+    timeline.step( 1.75 );
+    REQUIRE( output() == sequence.getValue( 1.75 ) );
+  }
+}
+
 TEST_CASE( "Slicing Time" )
 {
   SECTION( "Clip Phrases retime existing phrases and clamp their end values." )
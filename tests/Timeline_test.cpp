@@ -7,6 +7,7 @@
 
 #include "catch.hpp"
 #include "choreograph/Choreograph.h"
+#include <thread>
 
 using namespace choreograph;
 using namespace std;
@@ -38,6 +39,20 @@ TEST_CASE( "Timeline" )
     }
   }
 
+  SECTION( "rampTo appends a RampTo, and staticRampTo appends a StaticRampTo." )
+  {
+    Output<float> a = 0.0f, b = 0.0f;
+    auto &dynamic = timeline.apply( &a ).rampTo( 5.0f, 1.0f, EaseOutQuad() ).getMotion();
+    auto &fixed = timeline.apply( &b ).staticRampTo( 5.0f, 1.0f, EaseOutQuad() ).getMotion();
+
+    REQUIRE( dynamic_pointer_cast<RampTo<float>>( dynamic.getSequence().getPhraseAtIndex( 0 ) ) );
+    using QuadRamp = StaticRampTo<float, EaseOutQuad>;
+    REQUIRE( dynamic_pointer_cast<QuadRamp>( fixed.getSequence().getPhraseAtIndex( 0 ) ) );
+
+    timeline.jumpTo( 0.3f );
+    REQUIRE( a() == b() );
+  }
+
   SECTION( "Output<T> pointers can be controlled via Timeline." )
   {
     Output<float> target = 0.0f;
@@ -79,6 +94,261 @@ TEST_CASE( "Timeline" )
     REQUIRE( target == 10.0f );
   }
 
+  SECTION( "Raw pointer Motions are found by target among many." )
+  {
+    vector<float> targets( 1000, 0.0f );
+    for( auto &target : targets ) {
+      timeline.applyRaw( &target, sequence );
+    }
+    // Re-applying cancels the previous Motion, and appending finds the new one.
+    timeline.applyRaw( &targets[10] ).hold( 0.5f );
+    timeline.appendRaw( &targets[10] ).then<RampTo>( 2.0f, 1.0f );
+    timeline.appendRaw( &targets[20] ).then<RampTo>( 20.0f, 1.0f );
+    REQUIRE( timeline.size() == 1001 );
+
+    timeline.step( 1.5f );
+    REQUIRE( timeline.size() == 999 );
+    REQUIRE( targets[0] == 5.5f );
+    REQUIRE( targets[10] == 2.0f );
+    REQUIRE( targets[20] == 5.5f );
+
+    timeline.step( 2.5f );
+    REQUIRE( targets[20] == 20.0f );
+    REQUIRE( timeline.empty() );
+  }
+
+  SECTION( "Each type has its own key." )
+  {
+    REQUIRE( detail::typeKey<float>() != detail::typeKey<int>() );
+    REQUIRE( detail::typeKey<Motion<float>>() != detail::typeKey<Motion<int>>() );
+    REQUIRE( detail::typeKey<float>() == detail::typeKey<float>() );
+  }
+
+  SECTION( "Moving an Output moves its Motion in the target index." )
+  {
+    Output<float> original = 0.0f;
+    timeline.apply( &original, sequence );
+    Output<float> moved = std::move( original );
+
+    timeline.appendRaw( moved.valuePtr() ).then<RampTo>( 0.0f, 1.0f );
+    REQUIRE( timeline.size() == 1 );
+    REQUIRE( timeline.getDuration() == 4.0f );
+  }
+
+  SECTION( "Waiting Motions start on the same step whether or not they are parked." )
+  {
+    vector<Output<float>> parked( 50 );
+    vector<Output<float>> stepped( 50 );
+    int updates = 0;
+    for( size_t i = 0; i < parked.size(); i += 1 )
+    {
+      auto delay = 0.1f + i * 0.07f;
+      auto &a = timeline.apply( &parked[i], sequence ).getMotion();
+      auto &b = timeline.apply( &stepped[i], sequence ).updateFn( [&updates] { updates += 1; } ).getMotion();
+      for( auto *motion : { &a, &b } )
+      {
+        if( i % 2 ) {
+          motion->setStartTime( delay );
+        }
+        else {
+          // Playing backward, the Motion waits until its time comes back to the end of its duration.
+          motion->setPlaybackSpeed( -1.5f );
+          motion->setTime( motion->getDuration() + delay );
+        }
+      }
+    }
+
+    bool all_equal = true;
+    while( ! timeline.empty() ) {
+      timeline.step( 1.0f / 60.0f );
+      for( size_t i = 0; i < parked.size(); i += 1 ) {
+        all_equal = all_equal && parked[i]() == stepped[i]();
+      }
+    }
+    REQUIRE( updates > 0 );
+    REQUIRE( all_equal );
+  }
+
+  SECTION( "Parked delayed Motions keep time and can be cut like stepped Motions." )
+  {
+    Output<float> stepped;
+    auto &parked_motion = timeline.apply( &target, sequence ).getMotion();
+    auto &stepped_motion = timeline.apply( &stepped, sequence ).updateFn( [] {} ).getMotion();
+    parked_motion.setStartTime( 1.0f );
+    stepped_motion.setStartTime( 1.0f );
+
+    timeline.step( 0.1f );
+    timeline.step( 0.4f );
+    REQUIRE( parked_motion.isParked() );
+    REQUIRE( parked_motion.time() == Approx( -0.5f ) );
+    REQUIRE( parked_motion.time() == stepped_motion.time() );
+    REQUIRE( parked_motion.getProgress() == stepped_motion.getProgress() );
+    REQUIRE( timeline.timeUntilFinish() == Approx( 3.5f ) );
+
+    parked_motion.cutIn( 1.0f );
+    stepped_motion.cutIn( 1.0f );
+    REQUIRE( parked_motion.getDuration() == stepped_motion.getDuration() );
+    bool all_equal = true;
+    while( ! timeline.empty() ) {
+      timeline.step( 1.0f / 60.0f );
+      all_equal = all_equal && target() == stepped();
+    }
+    REQUIRE( all_equal );
+  }
+
+  SECTION( "Motions sleep through Holds and match Motions that are stepped." )
+  {
+    auto held = Sequence<float>( 0.0f )
+      .then<RampTo>( 1.0f, 1.0f )
+      .then<Hold>( 1.0f, 2.0f )
+      .then<RampTo>( 5.0f, 1.0f )
+      .then<Hold>( 5.0f, 1.0f );
+
+    vector<Output<float>> sleeping( 20 );
+    vector<Output<float>> stepped( 20 );
+    vector<size_t>        sleeping_calls;
+    vector<size_t>        stepped_calls;
+    vector<Motion<float>*> motions;
+    for( size_t i = 0; i < sleeping.size(); i += 1 )
+    {
+      auto &a = timeline.apply( &sleeping[i], held )
+        .onInflection( 2, [&sleeping_calls, i] { sleeping_calls.push_back( i ); } )
+        .finishFn( [&sleeping_calls, i] { sleeping_calls.push_back( 100 + i ); } )
+        .getMotion();
+      auto &b = timeline.apply( &stepped[i], held )
+        .onInflection( 2, [&stepped_calls, i] { stepped_calls.push_back( i ); } )
+        .finishFn( [&stepped_calls, i] { stepped_calls.push_back( 100 + i ); } )
+        .updateFn( [] {} )
+        .getMotion();
+      motions.push_back( &a );
+      motions.push_back( &b );
+      for( auto *motion : { &a, &b } )
+      {
+        motion->setStartTime( i * 0.05f );
+        if( i % 2 ) {
+          motion->setPlaybackSpeed( -0.75f );
+          motion->setTime( motion->getDuration() );
+        }
+      }
+    }
+
+    timeline.step( 1.5f );
+    REQUIRE( motions[0]->isParked() );
+    REQUIRE( ! motions[1]->isParked() );
+
+    bool all_equal = true;
+    while( ! timeline.empty() ) {
+      timeline.step( 1.0f / 60.0f );
+      for( size_t i = 0; i < sleeping.size(); i += 1 ) {
+        all_equal = all_equal && sleeping[i]() == stepped[i]();
+      }
+    }
+    REQUIRE( all_equal );
+    // Woken Motions step after the others, so only calls in the same step may be reordered.
+    REQUIRE( sleeping_calls.size() == 40 );
+    std::sort( sleeping_calls.begin(), sleeping_calls.end() );
+    std::sort( stepped_calls.begin(), stepped_calls.end() );
+    REQUIRE( sleeping_calls == stepped_calls );
+  }
+
+  SECTION( "Sleeping Motions wake on seeks, speed changes, and Sequence edits." )
+  {
+    auto held = Sequence<float>( 0.0f )
+      .then<Hold>( 1.0f, 10.0f )
+      .then<RampTo>( 2.0f, 1.0f );
+    auto &motion = timeline.apply( &target, held ).getMotion();
+
+    timeline.step( 1.0f );
+    REQUIRE( motion.isParked() );
+    REQUIRE( target() == 1.0f );
+
+    motion.setTime( 10.5f );
+    REQUIRE( ! motion.isParked() );
+    timeline.step( 0.0f );
+    REQUIRE( target() == 1.5f );
+
+    motion.setTime( 2.0f );
+    timeline.step( 0.5f );
+    REQUIRE( motion.isParked() );
+    motion.setPlaybackSpeed( 4.0f );
+    REQUIRE( ! motion.isParked() );
+    timeline.step( 2.0f );
+    REQUIRE( target() == 1.5f );
+
+    motion.setTime( 2.0f );
+    timeline.step( 0.5f );
+    REQUIRE( motion.isParked() );
+    timeline.append( &target ).rampTo( 0.0f, 1.0f );
+    REQUIRE( ! motion.isParked() );
+    REQUIRE( timeline.getDuration() == 12.0f );
+  }
+
+  SECTION( "Sleeping Motions wake when their Timeline plays backward." )
+  {
+    auto held = Sequence<float>( 0.0f )
+      .then<RampTo>( 1.0f, 1.0f )
+      .then<Hold>( 1.0f, 1.0f )
+      .then<RampTo>( 2.0f, 1.0f );
+    auto &motion = timeline.apply( &target, held ).getMotion();
+
+    timeline.jumpTo( 1.5f );
+    REQUIRE( motion.isParked() );
+
+    SECTION( "Reversed playback speed." )
+    {
+      timeline.setPlaybackSpeed( -1.0f );
+      timeline.step( 0.1f );
+      REQUIRE( ! motion.isParked() );
+      timeline.step( 0.9f );
+      REQUIRE( target() == Approx( 0.5f ) );
+      REQUIRE( ! motion.isParked() );
+    }
+
+    SECTION( "Negative steps." )
+    {
+      timeline.step( -0.1f );
+      REQUIRE( ! motion.isParked() );
+      timeline.step( -0.9f );
+      REQUIRE( target() == Approx( 0.5f ) );
+
+      // Playing forward again, the Motion sleeps through the Hold once more.
+      timeline.step( 0.75f );
+      REQUIRE( motion.isParked() );
+      timeline.step( 1.0f );
+      REQUIRE( target() == Approx( 1.25f ) );
+    }
+
+    SECTION( "Scrubbing." )
+    {
+      timeline.jumpTo( 1.6f );
+      timeline.jumpTo( 0.5f );
+      REQUIRE( target() == Approx( 0.5f ) );
+    }
+  }
+
+  SECTION( "Sleeping Motions can be cut in like stepped Motions." )
+  {
+    auto held = Sequence<float>( 0.0f )
+      .then<Hold>( 0.0f, 2.0f )
+      .then<RampTo>( 2.0f, 1.0f );
+    Output<float> stepped;
+    auto &sleeping_motion = timeline.apply( &target, held ).getMotion();
+    auto &stepped_motion = timeline.apply( &stepped, held ).updateFn( [] {} ).getMotion();
+
+    timeline.step( 0.1f );
+    timeline.step( 0.9f );
+    REQUIRE( sleeping_motion.isParked() );
+    REQUIRE( sleeping_motion.time() == Approx( 1.0f ) );
+    REQUIRE( sleeping_motion.getProgress() == stepped_motion.getProgress() );
+
+    sleeping_motion.cutIn( 1.5f );
+    stepped_motion.cutIn( 1.5f );
+    REQUIRE( ! sleeping_motion.isParked() );
+    timeline.step( 1.5f );
+    REQUIRE( stepped() == Approx( 1.0f ) );
+    REQUIRE( target() == stepped() );
+  }
+
   SECTION( "Timeline duration is a function of all motions." )
   {
     Output<float> other = 0.0f;
@@ -95,6 +365,44 @@ TEST_CASE( "Timeline" )
       options.playbackSpeed( 0.5f );
       REQUIRE( timeline.timeUntilFinish() == 6.0f );
     }
+
+    SECTION( "Cached duration follows appends, start times, and removals." )
+    {
+      REQUIRE( timeline.getDuration() == 3.0f );
+      timeline.append( &other ).hold( 1.0f );
+      REQUIRE( timeline.getDuration() == 4.0f );
+      options.setStartTime( 0.5f );
+      REQUIRE( timeline.getDuration() == 4.5f );
+
+      timeline.cue( [] {}, 1.0f );
+      REQUIRE( timeline.getDuration() == 4.5f );
+      other.disconnect();
+      timeline.step( 0.1f );
+      REQUIRE( timeline.getDuration() == 1.0f );
+    }
+
+    SECTION( "Changes to nested timelines reach the outer timeline." )
+    {
+      auto inner = detail::make_unique<Timeline>();
+      inner->setDefaultRemoveOnFinish( false );
+      Output<float> nested = 0.0f;
+      inner->apply( &nested, sequence );
+      auto &inner_ref = *inner;
+      timeline.add( std::move( inner ) );
+      inner_ref.setStartTime( 1.0f );
+      inner_ref.setRemoveOnFinish( false );
+      REQUIRE( timeline.getDuration() == 4.0f );
+
+      inner_ref.append( &nested ).hold( 2.0f );
+      REQUIRE( timeline.getDuration() == 6.0f );
+
+      int finished = 0;
+      timeline.setFinishFn( [&finished] { finished += 1; } );
+      timeline.step( 5.5f );
+      REQUIRE( finished == 0 );
+      timeline.step( 0.5f );
+      REQUIRE( finished == 1 );
+    }
   }
 } // Timeline
 
@@ -247,3 +555,1171 @@ TEST_CASE( "Callbacks" )
     REQUIRE_FALSE( self_destructing_timeline );
   }
 }
+
+//==========================================
+// Bucketed Motion Storage
+//==========================================
+
+TEST_CASE( "Bucketed Motion Storage" )
+{
+  Timeline separate;
+  Timeline bucketed;
+  bucketed.setMotionStorage( MotionStorage::Bucketed );
+
+  auto sequence = Sequence<float>( 0.0f )
+    .then<RampTo>( 1.0f, 1.0f )
+    .then<RampTo>( 10.0f, 1.0f )
+    .then<RampTo>( 100.0f, 1.0f );
+
+  SECTION( "Bucketed Motions produce the same values and callbacks as separate Motions." )
+  {
+    vector<Output<float>>  a( 300 );
+    vector<Output<float>>  b( 300 );
+    vector<size_t>         separate_calls;
+    vector<size_t>         bucketed_calls;
+    vector<Motion<float>*> motions;
+
+    auto add = [&sequence] ( Timeline &timeline, Output<float> &output, vector<size_t> &calls, size_t i ) -> Motion<float>& {
+      auto &motion = timeline.apply( &output, sequence )
+        .startFn( [&calls, i] { calls.push_back( i ); } )
+        .onInflection( 2, [&calls, i] { calls.push_back( 1000 + i ); } )
+        .finishFn( [&calls, i] { calls.push_back( 2000 + i ); } )
+        .getMotion();
+      motion.setStartTime( i * 0.01f );
+      if( i % 3 == 0 ) {
+        motion.setPlaybackSpeed( -1.5f );
+        motion.setTime( motion.getDuration() );
+      }
+      return motion;
+    };
+
+    for( size_t i = 0; i < a.size(); i += 1 ) {
+      add( separate, a[i], separate_calls, i );
+      motions.push_back( &add( bucketed, b[i], bucketed_calls, i ) );
+    }
+    REQUIRE( bucketed.size() == 300 );
+    REQUIRE( bucketed.getDuration() == separate.getDuration() );
+
+    bool all_equal = true;
+    size_t most_bucketed = 0;
+    while( ! separate.empty() )
+    {
+      separate.step( 1.0f / 30.0f );
+      bucketed.step( 1.0f / 30.0f );
+      for( size_t i = 0; i < a.size(); i += 1 ) {
+        all_equal = all_equal && a[i]() == Approx( b[i]() );
+      }
+      if( ! bucketed.empty() ) {
+        REQUIRE( bucketed.timeUntilFinish() == Approx( separate.timeUntilFinish() ) );
+        most_bucketed = std::max<size_t>( most_bucketed, std::count_if( motions.begin(), motions.end(), [] ( Motion<float> *m ) { return m->isParked(); } ) );
+      }
+    }
+    REQUIRE( all_equal );
+    REQUIRE( bucketed.empty() );
+    REQUIRE( most_bucketed > 200 );
+    // Motions leaving their bucket step after the others, so only calls in the same step may be reordered.
+    // Forward Motions fire all three callbacks.
+    REQUIRE( separate_calls.size() >= 600 );
+    std::sort( separate_calls.begin(), separate_calls.end() );
+    std::sort( bucketed_calls.begin(), bucketed_calls.end() );
+    REQUIRE( bucketed_calls == separate_calls );
+  }
+
+  SECTION( "Bucketed Motions sleep through waits and Holds like separate Motions." )
+  {
+    auto held = Sequence<float>( 0.0f )
+      .then<RampTo>( 1.0f, 1.0f )
+      .then<Hold>( 1.0f, 2.0f )
+      .then<RampTo>( 5.0f, 1.0f );
+
+    vector<Output<float>> a( 40 );
+    vector<Output<float>> b( 40 );
+    for( size_t i = 0; i < a.size(); i += 1 ) {
+      separate.apply( &a[i], held ).setStartTime( i * 0.05f );
+      bucketed.apply( &b[i], held ).setStartTime( i * 0.05f );
+    }
+
+    bool all_equal = true;
+    separate.step( 1.5f );
+    bucketed.step( 1.5f );
+    while( ! separate.empty() ) {
+      separate.step( 1.0f / 30.0f );
+      bucketed.step( 1.0f / 30.0f );
+      // Motions in a Hold aren't stepped at all.
+      all_equal = all_equal && bucketed.getUpdatedItemCount() <= separate.getUpdatedItemCount();
+      for( size_t i = 0; i < a.size(); i += 1 ) {
+        all_equal = all_equal && a[i]() == Approx( b[i]() );
+      }
+    }
+    REQUIRE( all_equal );
+    REQUIRE( bucketed.empty() );
+  }
+
+  SECTION( "Bucketed Motions wake when their timing, Sequence, or target changes." )
+  {
+    Output<float> target;
+    auto &motion = bucketed.apply( &target, sequence ).getMotion();
+    bucketed.step( 0.5f );
+    REQUIRE( motion.isParked() );
+    bucketed.step( 0.25f );
+    REQUIRE( target() == 0.75f );
+    REQUIRE( motion.time() == 0.75f );
+
+    motion.setPlaybackSpeed( 0.5f );
+    REQUIRE_FALSE( motion.isParked() );
+    bucketed.step( 0.1f );
+    REQUIRE( target() == Approx( 0.8f ) );
+    REQUIRE( motion.isParked() );
+
+    Output<float> moved = std::move( target );
+    REQUIRE_FALSE( motion.isParked() );
+    bucketed.step( 0.1f );
+    REQUIRE( moved() == Approx( 0.85f ) );
+
+    bucketed.append( &moved ).rampTo( 0.0f, 1.0f );
+    REQUIRE_FALSE( motion.isParked() );
+    REQUIRE( bucketed.getDuration() == 4.0f );
+
+    bucketed.step( 0.1f );
+    REQUIRE( motion.isParked() );
+    motion.setUpdateInterval( 0.25f );
+    REQUIRE_FALSE( motion.isParked() );
+    // Throttled Motions are stepped separately.
+    bucketed.step( 0.1f );
+    REQUIRE_FALSE( motion.isParked() );
+  }
+
+  SECTION( "Bucketed Motions wake when cancelled, disconnected, or seeked." )
+  {
+    Output<float> a;
+    Output<float> c;
+    auto handle = bucketed.apply( &a, sequence ).getHandle();
+    auto &seeked = bucketed.apply( &c, sequence ).getMotion();
+    {
+      Output<float> b;
+      bucketed.apply( &b, sequence );
+      bucketed.step( 0.5f );
+      REQUIRE( bucketed.size() == 3 );
+    }
+    handle.cancel();
+    bucketed.step( 0.1f );
+    REQUIRE( bucketed.size() == 1 );
+    REQUIRE( a() == 0.5f );
+    REQUIRE( c() == Approx( 0.6f ) );
+
+    bucketed.jumpTo( 2.5f );
+    REQUIRE( c() == Approx( 55.0f ) );
+    REQUIRE( seeked.isParked() );
+
+    bucketed.setTime( 0.0f );
+    REQUIRE_FALSE( seeked.isParked() );
+    REQUIRE( seeked.time() == 0.0f );
+    bucketed.step( 0.25f );
+    REQUIRE( c() == 0.25f );
+  }
+
+  SECTION( "Bucketed Motions follow their Timeline backward." )
+  {
+    Output<float> a;
+    Output<float> b;
+    separate.apply( &a, sequence );
+    auto &motion = bucketed.apply( &b, sequence ).getMotion();
+
+    for( auto dt : { 1.5f, -0.25f, -0.5f, 0.5f, -0.125f } )
+    {
+      separate.step( dt );
+      bucketed.step( dt );
+      REQUIRE( a() == b() );
+    }
+    REQUIRE( motion.isParked() );
+
+    separate.jumpTo( 2.5f );
+    bucketed.jumpTo( 2.5f );
+    REQUIRE( a() == b() );
+    separate.jumpTo( 0.25f );
+    bucketed.jumpTo( 0.25f );
+    REQUIRE( b() == 0.25f );
+  }
+
+  SECTION( "Bucketed Motions flag pool elements, report changes, and evaluate lazily." )
+  {
+    OutputPool<float> pool( 4 );
+    Output<float>     lazy;
+    float             raw = 0.0f;
+    bucketed.setChangeTracking( true );
+    bucketed.setLazyEvaluation( true );
+    for( size_t i = 0; i < pool.size(); i += 1 ) {
+      bucketed.apply( &pool, i, sequence );
+    }
+    bucketed.apply( &lazy, sequence );
+    bucketed.applyRaw( &raw, sequence );
+
+    bucketed.step( 0.5f );
+    pool.clearChanged();
+    bucketed.step( 0.25f );
+    REQUIRE( pool.inputPtr( 3 )->isParked() );
+    REQUIRE( lazy.inputPtr()->isParked() );
+    REQUIRE( pool.changed( 3 ) );
+    REQUIRE( pool[3] == 0.75f );
+    REQUIRE( raw == 0.75f );
+    // Lazy Outputs aren't reported.
+    REQUIRE( bucketed.getChangedTargets().size() == 5 );
+    REQUIRE( lazy() == 0.75f );
+  }
+
+  SECTION( "Motions of different types live alongside Cues." )
+  {
+    Output<float> f = 0.0f;
+    Output<int>   i = 0;
+    int           cue_count = 0;
+
+    bucketed.apply( &f ).rampTo( 10.0f, 1.0f );
+    bucketed.apply( &i ).then<RampTo>( 10, 2.0f );
+    bucketed.cue( [&cue_count] { cue_count += 1; }, 0.5f );
+
+    REQUIRE( bucketed.size() == 3 );
+    bucketed.step( 0.5f );
+    REQUIRE( f() == 5.0f );
+    REQUIRE( i() == 2 );
+    REQUIRE( cue_count == 1 );
+    REQUIRE( bucketed.size() == 2 );
+
+    bucketed.step( 0.25f );
+    REQUIRE( f() == 7.5f );
+    REQUIRE( i() == 3 );
+    bucketed.step( 0.25f );
+    REQUIRE( bucketed.size() == 1 );
+    bucketed.step( 1.0f );
+    REQUIRE( bucketed.empty() );
+  }
+
+  SECTION( "Appending and callbacks work on bucketed Motions." )
+  {
+    Output<float> target = 0.0f;
+    int           finish_count = 0;
+
+    bucketed.apply( &target ).rampTo( 1.0f, 1.0f );
+    bucketed.append( &target )
+      .rampTo( 2.0f, 1.0f )
+      .finishFn( [&finish_count] { finish_count += 1; } );
+
+    REQUIRE( bucketed.timeUntilFinish() == 2.0f );
+    bucketed.step( 1.5f );
+    REQUIRE( target() == 1.5f );
+    bucketed.step( 0.25f );
+    REQUIRE( target() == 1.75f );
+    REQUIRE( finish_count == 0 );
+    bucketed.step( 1.0f );
+    REQUIRE( finish_count == 1 );
+    REQUIRE( bucketed.empty() );
+  }
+
+  SECTION( "Destroyed Outputs remove their bucketed Motions." )
+  {
+    for( int round = 0; round < 3; round += 1 )
+    {
+      {
+        vector<Output<float>> outputs( 100 );
+        for( auto &output : outputs ) {
+          bucketed.apply( &output, sequence );
+        }
+        bucketed.step( 0.1f );
+        REQUIRE( outputs[0].inputPtr()->isParked() );
+        REQUIRE( bucketed.size() == 100 );
+      }
+      bucketed.step( 0.1f );
+      REQUIRE( bucketed.empty() );
+    }
+  }
+
+  SECTION( "Raw pointer Motions can be applied and appended." )
+  {
+    float target = 0.0f;
+    float other = 5.0f;
+    bucketed.applyRaw( &target, sequence );
+    bucketed.appendRaw( &target ).then<RampTo>( 0.0f, 1.0f );
+    REQUIRE( bucketed.size() == 1 );
+    REQUIRE( bucketed.getDuration() == 4.0f );
+
+    bucketed.appendRaw( &other ).hold( 1.0f );
+    REQUIRE( bucketed.size() == 2 );
+    bucketed.step( 1.0f );
+    REQUIRE( other == 5.0f );
+    REQUIRE( bucketed.size() == 1 );
+
+    bucketed.step( 0.5f );
+    REQUIRE( target == 5.5f );
+    bucketed.applyRaw( &target, sequence );
+    bucketed.step( 1.0f );
+    REQUIRE( target == 1.0f );
+    REQUIRE( bucketed.size() == 1 );
+
+    bucketed.clear();
+    REQUIRE( bucketed.empty() );
+    bucketed.step( 1.0f );
+    REQUIRE( target == 1.0f );
+  }
+}
+
+//==========================================
+// Parallel Evaluation
+//==========================================
+
+TEST_CASE( "Parallel Timeline Update" )
+{
+  ThreadPool pool( 3 );
+  Timeline   serial;
+  Timeline   parallel;
+  parallel.setParallelExecutor( pool.getExecutor( 16 ) );
+
+  auto sequence = Sequence<float>( 0.0f )
+    .then<RampTo>( 1.0f, 1.0f )
+    .then<RampTo>( 10.0f, 1.0f )
+    .then<RampTo>( 100.0f, 1.0f );
+
+  SECTION( "ThreadPool covers every index exactly once." )
+  {
+    vector<int> counts( 1000, 0 );
+    pool.parallelFor( counts.size(), 7, [&counts] ( size_t begin, size_t end ) {
+      for( size_t i = begin; i < end; i += 1 ) {
+        counts[i] += 1;
+      }
+    } );
+
+    REQUIRE( std::all_of( counts.begin(), counts.end(), [] ( int c ) { return c == 1; } ) );
+  }
+
+  SECTION( "ThreadPool runs calls from several threads and nested calls to completion." )
+  {
+    vector<int> a( 1000, 0 );
+    vector<int> b( 1000, 0 );
+    auto count_in = [&pool] ( vector<int> &counts ) {
+      for( int repeat = 0; repeat < 50; repeat += 1 ) {
+        pool.parallelFor( counts.size(), 7, [&counts] ( size_t begin, size_t end ) {
+          for( size_t i = begin; i < end; i += 1 ) {
+            counts[i] += 1;
+          }
+        } );
+      }
+    };
+    std::thread other( [&] { count_in( b ); } );
+    count_in( a );
+    other.join();
+
+    REQUIRE( std::all_of( a.begin(), a.end(), [] ( int c ) { return c == 50; } ) );
+    REQUIRE( std::all_of( b.begin(), b.end(), [] ( int c ) { return c == 50; } ) );
+
+    vector<int> nested( 100 * 100, 0 );
+    pool.parallelFor( 100, 1, [&pool, &nested] ( size_t outer_begin, size_t outer_end ) {
+      for( size_t row = outer_begin; row < outer_end; row += 1 ) {
+        pool.parallelFor( 100, 7, [&nested, row] ( size_t begin, size_t end ) {
+          for( size_t i = begin; i < end; i += 1 ) {
+            nested[row * 100 + i] += 1;
+          }
+        } );
+      }
+    } );
+    REQUIRE( std::all_of( nested.begin(), nested.end(), [] ( int c ) { return c == 1; } ) );
+  }
+
+  SECTION( "Parallel update produces the same values and callback order as serial update." )
+  {
+    vector<Output<float>> a( 200 );
+    vector<Output<float>> b( 200 );
+    vector<size_t>        serial_calls;
+    vector<size_t>        parallel_calls;
+
+    for( size_t i = 0; i < a.size(); i += 1 )
+    {
+      serial.apply( &a[i], sequence )
+        .setStartTime( i * 0.01f )
+        .finishFn( [&serial_calls, i] { serial_calls.push_back( i ); } );
+      parallel.apply( &b[i], sequence )
+        .setStartTime( i * 0.01f )
+        .finishFn( [&parallel_calls, i] { parallel_calls.push_back( i ); } );
+
+      if( i % 10 == 0 ) {
+        serial.cue( [&serial_calls, i] { serial_calls.push_back( 1000 + i ); }, i * 0.02f );
+        parallel.cue( [&parallel_calls, i] { parallel_calls.push_back( 1000 + i ); }, i * 0.02f );
+      }
+    }
+
+    while( ! serial.empty() ) {
+      serial.step( 0.05f );
+      parallel.step( 0.05f );
+
+      bool all_equal = true;
+      for( size_t i = 0; i < a.size(); i += 1 ) {
+        if( a[i]() != b[i]() ) {
+          all_equal = false;
+        }
+      }
+      REQUIRE( all_equal );
+    }
+
+    REQUIRE( parallel.empty() );
+    REQUIRE( serial_calls.size() == 220 );
+    REQUIRE( serial_calls == parallel_calls );
+  }
+
+  SECTION( "Bucketed Motions are evaluated in parallel, too." )
+  {
+    parallel.setMotionStorage( MotionStorage::Bucketed );
+    vector<Output<float>> outputs( 100 );
+    for( auto &output : outputs ) {
+      parallel.apply( &output, sequence );
+    }
+
+    parallel.step( 1.25f );
+    REQUIRE( outputs[0].inputPtr()->isParked() );
+    parallel.step( 0.25f );
+    REQUIRE( std::all_of( outputs.begin(), outputs.end(), [] ( const Output<float> &o ) { return o() == 5.5f; } ) );
+  }
+
+  SECTION( "Motions with Phrases that aren't thread safe are evaluated on the updating thread." )
+  {
+    const auto updating_thread = std::this_thread::get_id();
+    bool       all_on_updating_thread = true;
+    auto procedural = Sequence<float>( 0.0f ).then( PhraseRef<float>( detail::make_pooled<ProceduralPhrase<float>>( 1.0f, [&] ( Time t, Time ) {
+      all_on_updating_thread = all_on_updating_thread && std::this_thread::get_id() == updating_thread;
+      return (float)t;
+    } ) ) );
+    auto mixed = Sequence<float>( PhraseRef<float>( make_shared<MixPhrase<float>>( sequence.asPhrase(), procedural.asPhrase() ) ) );
+
+    REQUIRE( sequence.isThreadSafe() );
+    REQUIRE_FALSE( procedural.isThreadSafe() );
+    REQUIRE_FALSE( mixed.isThreadSafe() );
+    REQUIRE_FALSE( procedural.slice( 0.25f, 0.75f ).isThreadSafe() );
+    auto spliced = procedural;
+    spliced.splice( 0, 1, {} );
+    REQUIRE( spliced.isThreadSafe() );
+
+    vector<Output<float>> outputs( 64 );
+    for( size_t i = 0; i < outputs.size(); i += 1 ) {
+      parallel.apply( &outputs[i], (i % 2) ? procedural : mixed );
+    }
+    parallel.setMotionStorage( MotionStorage::Bucketed );
+    vector<Output<float>> bucketed_outputs( 64 );
+    for( auto &output : bucketed_outputs ) {
+      parallel.apply( &output, procedural );
+    }
+
+    parallel.step( 0.5f );
+    REQUIRE( bucketed_outputs[0].inputPtr()->isParked() );
+    parallel.step( 0.25f );
+    REQUIRE( all_on_updating_thread );
+    REQUIRE( outputs[1]() == 0.75f );
+    REQUIRE( bucketed_outputs[0]() == 0.75f );
+  }
+}
+
+TEST_CASE( "Posted Commands" )
+{
+  Timeline timeline;
+  auto sequence = Sequence<float>( 0.0f ).then<RampTo>( 1.0f, 1.0f );
+
+  SECTION( "Commands can't be posted until the queue is enabled." )
+  {
+    REQUIRE( timeline.postCue( [] {}, 0.0f ) == false );
+    REQUIRE( timeline.getDroppedCommandCount() == 0 );
+  }
+
+  SECTION( "Commands posted from many threads run at the start of the next update." )
+  {
+    timeline.setCommandQueueCapacity( 4096 );
+    vector<Output<float>> outputs( 1000 );
+    std::atomic<int> cue_count( 0 );
+
+    vector<std::thread> threads;
+    for( size_t t = 0; t < 4; t += 1 ) {
+      threads.emplace_back( [&, t] {
+        for( size_t i = t; i < outputs.size(); i += 4 ) {
+          timeline.postApply( &outputs[i], sequence );
+          timeline.postCue( [&cue_count] { cue_count += 1; }, 0.0f );
+        }
+      } );
+    }
+    for( auto &thread : threads ) {
+      thread.join();
+    }
+
+    REQUIRE( timeline.getCommandQueueDepth() == 2000 );
+    REQUIRE( timeline.empty() );
+
+    timeline.step( 0.5f );
+    REQUIRE( timeline.getCommandQueueDepth() == 0 );
+    REQUIRE( timeline.getDroppedCommandCount() == 0 );
+    REQUIRE( cue_count == 1000 );
+    REQUIRE( std::all_of( outputs.begin(), outputs.end(), [] ( const Output<float> &o ) { return o() == 0.5f; } ) );
+
+    timeline.postAppend( &outputs[0], sequence );
+    timeline.postCancel( &outputs[1] );
+    timeline.step( 0.5f );
+    REQUIRE( outputs[0]() == 1.0f );
+    REQUIRE( timeline.size() == 1 );
+  }
+
+  SECTION( "A full queue drops commands and counts them." )
+  {
+    timeline.setCommandQueueCapacity( 4 );
+    int calls = 0;
+    for( int i = 0; i < 10; i += 1 ) {
+      timeline.post( [&calls] ( Timeline & ) { calls += 1; } );
+    }
+    REQUIRE( timeline.getCommandQueueDepth() == 4 );
+    REQUIRE( timeline.getDroppedCommandCount() == 6 );
+
+    timeline.step( 0.1f );
+    REQUIRE( calls == 4 );
+    REQUIRE( timeline.post( [&calls] ( Timeline & ) { calls += 1; } ) );
+  }
+}
+
+TEST_CASE( "Output Buffers" )
+{
+  Timeline timeline;
+  auto sequence = Sequence<float>( 0.0f ).then<RampTo>( 100.0f, 1.0f );
+
+  SECTION( "Readers see the latest published values." )
+  {
+    OutputBuffer<float> buffer( 3, 5.0f );
+    timeline.attach( buffer );
+    for( size_t i = 0; i < buffer.size(); i += 1 ) {
+      timeline.apply( &buffer[i], sequence );
+    }
+
+    timeline.step( 0.5f );
+    REQUIRE( buffer.read() == vector<float>( 3, 5.0f ) );
+
+    timeline.publish();
+    timeline.step( 0.25f );
+    REQUIRE( buffer.read() == vector<float>( 3, 50.0f ) );
+    REQUIRE( buffer.read() == vector<float>( 3, 50.0f ) );
+
+    timeline.publish();
+    timeline.publish();
+    REQUIRE( buffer.read() == vector<float>( 3, 75.0f ) );
+  }
+
+  SECTION( "Buffers and Timelines can be destroyed in either order." )
+  {
+    auto buffer = detail::make_unique<OutputBuffer<int>>( 1 );
+    {
+      Timeline other;
+      other.attach( *buffer );
+      timeline.attach( *buffer );
+      other.publish();
+    }
+    timeline.publish();
+    buffer.reset();
+    timeline.publish();
+  }
+
+  SECTION( "Snapshots read on another thread come from a single step." )
+  {
+    OutputBuffer<float> buffer( 256 );
+    timeline.attach( buffer );
+    timeline.setDefaultRemoveOnFinish( false );
+    for( size_t i = 0; i < buffer.size(); i += 1 ) {
+      timeline.apply( &buffer[i], sequence );
+    }
+
+    std::atomic<bool> done( false );
+    bool consistent = true;
+    std::thread reader( [&] {
+      while( ! done ) {
+        const auto &values = buffer.read();
+        consistent = consistent && std::all_of( values.begin(), values.end(), [&values] ( float v ) { return v == values[0]; } );
+      }
+    } );
+
+    for( int i = 0; i < 1000; i += 1 ) {
+      timeline.step( 0.001f );
+      timeline.publish();
+    }
+    done = true;
+    reader.join();
+
+    REQUIRE( consistent );
+    REQUIRE( buffer.read()[0] == buffer[0]() );
+  }
+}
+
+TEST_CASE( "Output Pools" )
+{
+  Timeline timeline;
+  auto sequence = Sequence<float>( 0.0f ).then<RampTo>( 100.0f, 1.0f );
+
+  SECTION( "Motions write pool values contiguously." )
+  {
+    OutputPool<float> pool( 4, 1.0f );
+    for( size_t i = 0; i < pool.size(); i += 2 ) {
+      timeline.apply( &pool, i, sequence );
+    }
+    timeline.append( &pool, 2 ).hold( 1.0f );
+    timeline.append( &pool, 3 ).then<RampTo>( 5.0f, 1.0f );
+
+    timeline.step( 0.5f );
+    const float expected[] = { 50.0f, 1.0f, 50.0f, 3.0f };
+    REQUIRE( std::equal( pool.data(), pool.data() + pool.size(), expected ) );
+    REQUIRE( timeline.getDuration() == 2.0f );
+  }
+
+  SECTION( "Applying to an element disconnects its previous Motion." )
+  {
+    OutputPool<float> pool( 2 );
+    auto &first = timeline.apply( &pool, 0, sequence ).getMotion();
+    timeline.apply( &pool, 0 ).then<RampTo>( 10.0f, 1.0f );
+    REQUIRE( first.cancelled() );
+    REQUIRE( pool.inputPtr( 0 ) != &first );
+
+    pool.disconnect( 0 );
+    REQUIRE( ! pool.isConnected( 0 ) );
+    timeline.step( 0.1f );
+    REQUIRE( timeline.empty() );
+  }
+
+  SECTION( "Moved pools keep their Motions, and destroyed pools disconnect them." )
+  {
+    auto pool = OutputPool<float>( 100 );
+    for( size_t i = 0; i < pool.size(); i += 1 ) {
+      timeline.apply( &pool, i, sequence );
+    }
+    auto moved = std::move( pool );
+    timeline.step( 0.25f );
+    REQUIRE( moved[99] == 25.0f );
+
+    {
+      auto destroyed = std::move( moved );
+    }
+    timeline.step( 0.25f );
+    REQUIRE( timeline.empty() );
+  }
+
+  SECTION( "Pool elements work with bucketed Motions." )
+  {
+    timeline.setMotionStorage( MotionStorage::Bucketed );
+    OutputPool<float> pool( 10 );
+    for( size_t i = 0; i < pool.size(); i += 1 ) {
+      timeline.apply( &pool, i, sequence );
+    }
+    timeline.step( 0.25f );
+    timeline.step( 0.25f );
+    REQUIRE( pool.inputPtr( 9 )->isParked() );
+    REQUIRE( pool[9] == 50.0f );
+    timeline.step( 1.0f );
+    REQUIRE( std::all_of( pool.data(), pool.data() + pool.size(), [] ( float v ) { return v == 100.0f; } ) );
+  }
+}
+
+TEST_CASE( "Change Tracking" )
+{
+  Timeline timeline;
+  auto sequence = Sequence<float>( 0.0f )
+    .then<RampTo>( 1.0f, 1.0f )
+    .then<Hold>( 1.0f, 1.0f )
+    .then<RampTo>( 2.0f, 1.0f );
+
+  SECTION( "Unchanged values aren't written or reported." )
+  {
+    Output<float> a;
+    Output<float> b;
+    timeline.setChangeTracking( true );
+    timeline.apply( &a, sequence );
+    timeline.apply( &b ).hold( 1.0f ).then<RampTo>( 1.0f, 1.0f );
+
+    timeline.step( 0.5f );
+    REQUIRE( timeline.getChangedTargets() == vector<const void*>{ a.valuePtr() } );
+
+    timeline.step( 1.0f );
+    REQUIRE( timeline.getChangedTargets() == ( vector<const void*>{ a.valuePtr(), b.valuePtr() } ) );
+
+    // a holds at 1 while b ramps.
+    timeline.step( 0.25f );
+    REQUIRE( timeline.getChangedTargets() == vector<const void*>{ b.valuePtr() } );
+
+    timeline.setChangeTracking( false );
+    timeline.step( 1.0f );
+    REQUIRE( timeline.getChangedTargets().empty() );
+  }
+
+  SECTION( "Pools flag changed elements until cleared." )
+  {
+    OutputPool<float> pool( 4 );
+    timeline.apply( &pool, 1, sequence );
+    timeline.apply( &pool, 3, sequence ).setStartTime( 2.0f );
+
+    timeline.step( 0.5f );
+    REQUIRE( pool.changed( 1 ) );
+    REQUIRE( ! pool.changed( 3 ) );
+
+    timeline.step( 1.0f );
+    timeline.step( 0.25f );
+    vector<size_t> changed;
+    pool.forEachChanged( [&changed] ( size_t i ) { changed.push_back( i ); } );
+    REQUIRE( changed == vector<size_t>{ 1 } );
+
+    pool.clearChanged();
+    timeline.step( 0.1f );
+    REQUIRE( ! pool.changed( 1 ) );
+  }
+
+  SECTION( "Parallel update reports the same changes as serial update." )
+  {
+    ThreadPool threads( 3 );
+    Timeline   parallel;
+    parallel.setParallelExecutor( threads.getExecutor( 16 ) );
+    timeline.setChangeTracking( true );
+    parallel.setChangeTracking( true );
+
+    vector<Output<float>> a( 100 );
+    vector<Output<float>> b( 100 );
+    for( size_t i = 0; i < a.size(); i += 1 ) {
+      timeline.apply( &a[i], sequence ).setStartTime( i * 0.02f );
+      parallel.apply( &b[i], sequence ).setStartTime( i * 0.02f );
+    }
+
+    while( ! timeline.empty() ) {
+      timeline.step( 0.1f );
+      parallel.step( 0.1f );
+
+      auto indices = [] ( const vector<const void*> &targets, const vector<Output<float>> &outputs ) {
+        vector<size_t> result;
+        for( auto target : targets ) {
+          auto found = std::find_if( outputs.begin(), outputs.end(), [target] ( const Output<float> &o ) { return o.valuePtr() == target; } );
+          result.push_back( found - outputs.begin() );
+        }
+        return result;
+      };
+      REQUIRE( indices( timeline.getChangedTargets(), a ) == indices( parallel.getChangedTargets(), b ) );
+    }
+  }
+}
+
+TEST_CASE( "Lazy Evaluation" )
+{
+  Timeline timeline;
+  timeline.setLazyEvaluation( true );
+
+  int evaluations = 0;
+  auto counted = Sequence<float>( detail::make_pooled<ProceduralPhrase<float>>( 1.0f, [&evaluations] ( Time t, Time ) {
+    evaluations += 1;
+    return (float)( t * 10 );
+  } ) );
+  // Constructing the Sequence reads its start value.
+  evaluations = 0;
+
+  SECTION( "Outputs evaluate once when read after a step." )
+  {
+    vector<Output<float>> outputs( 10 );
+    for( auto &output : outputs ) {
+      timeline.apply( &output, counted );
+    }
+
+    timeline.step( 0.5f );
+    timeline.step( 0.25f );
+    REQUIRE( evaluations == 0 );
+
+    REQUIRE( outputs[3]() == 7.5f );
+    REQUIRE( outputs[3].value() == 7.5f );
+    REQUIRE( evaluations == 1 );
+  }
+
+  SECTION( "Callbacks fire during the step and can read lazy Outputs." )
+  {
+    Output<float> target;
+    float         seen = 0;
+    int           finished = 0;
+    timeline.apply( &target, counted )
+      .updateFn( [&target, &seen] { seen = target(); } )
+      .finishFn( [&finished] { finished += 1; } );
+
+    timeline.step( 0.5f );
+    REQUIRE( seen == 5.0f );
+    timeline.step( 1.0f );
+    REQUIRE( finished == 1 );
+  }
+
+  SECTION( "Finished and replaced Motions leave their final value." )
+  {
+    Output<float> target;
+    timeline.apply( &target, counted );
+    timeline.step( 2.0f );
+    REQUIRE( timeline.empty() );
+    REQUIRE( evaluations == 1 );
+    REQUIRE( target() == 10.0f );
+
+    timeline.apply( &target, counted );
+    timeline.step( 0.5f );
+    timeline.apply( &target ).then<RampTo>( 0.0f, 1.0f );
+    REQUIRE( target() == 5.0f );
+  }
+
+  SECTION( "Moved Outputs stay lazy, and assignment overrides the pending value." )
+  {
+    Output<float> target;
+    timeline.apply( &target, counted );
+    timeline.step( 0.5f );
+
+    auto moved = std::move( target );
+    REQUIRE( evaluations == 0 );
+    REQUIRE( moved() == 5.0f );
+
+    timeline.step( 0.1f );
+    moved = 1.0f;
+    REQUIRE( moved() == 1.0f );
+    REQUIRE( evaluations == 1 );
+  }
+
+  SECTION( "Raw pointers and pools are still written while stepping." )
+  {
+    float             raw = 0;
+    OutputPool<float> pool( 1 );
+    timeline.applyRaw( &raw, counted );
+    timeline.apply( &pool, 0, counted );
+    timeline.step( 0.5f );
+    REQUIRE( evaluations == 2 );
+    REQUIRE( raw == 5.0f );
+    REQUIRE( pool[0] == 5.0f );
+  }
+}
+
+TEST_CASE( "Update Rates" )
+{
+  Timeline timeline;
+  auto sequence = Sequence<float>( 0.0f ).then<RampTo>( 60.0f, 1.0f );
+  const float dt = 1.0f / 60.0f;
+
+  SECTION( "Throttled items keep time and spread their updates across steps." )
+  {
+    vector<Output<float>> throttled( 12 );
+    Output<float>         every_step;
+    int                   finished = 0;
+    for( auto &output : throttled ) {
+      timeline.apply( &output, sequence )
+        .updateRate( 10 )
+        .finishFn( [&finished] { finished += 1; } );
+    }
+    timeline.apply( &every_step, sequence );
+
+    size_t most_updated = 0;
+    size_t total_updated = 0;
+    for( int i = 0; i < 6; i += 1 )
+    {
+      timeline.step( dt );
+      auto counted = timeline.getUpdatedItemCount() + timeline.getSkippedItemCount();
+      REQUIRE( counted == 13 );
+      most_updated = std::max( most_updated, timeline.getUpdatedItemCount() );
+      total_updated += timeline.getUpdatedItemCount();
+    }
+    // Each throttled Motion updated once in six steps, no more than three at a time alongside the full-rate one.
+    REQUIRE( total_updated == 6 + 12 );
+    REQUIRE( most_updated <= 1 + 3 );
+
+    // Throttled values are always values the Sequence passed through recently.
+    for( auto &output : throttled ) {
+      REQUIRE( output() <= every_step() );
+      REQUIRE( output() >= every_step() - 6.0f );
+    }
+
+    while( ! timeline.empty() ) {
+      timeline.step( dt );
+    }
+    REQUIRE( finished == 12 );
+    REQUIRE( std::all_of( throttled.begin(), throttled.end(), [] ( const Output<float> &o ) { return o() == 60.0f; } ) );
+  }
+
+  SECTION( "Throttled Motions reach the same times as full-rate Motions." )
+  {
+    Output<float> throttled;
+    Output<float> every_step;
+    timeline.apply( &throttled, sequence ).updateInterval( 0.1f );
+    timeline.apply( &every_step, sequence );
+
+    bool matched = false;
+    for( int i = 0; i < 30; i += 1 ) {
+      timeline.step( dt );
+      matched = matched || throttled() == every_step();
+    }
+    REQUIRE( matched );
+
+    timeline.jumpTo( 0.5f );
+    REQUIRE( every_step() == Approx( 30.0f ) );
+  }
+
+  SECTION( "Throttled Motions keep time while sleeping through Holds." )
+  {
+    auto held = Sequence<float>( 0.0f )
+      .then<RampTo>( 1.0f, 0.5f )
+      .then<Hold>( 1.0f, 2.0f )
+      .then<RampTo>( 2.0f, 0.5f );
+    Output<float> throttled;
+    Output<float> every_step;
+    Timeline      reference;
+    timeline.apply( &throttled, held ).updateRate( 10 );
+    reference.apply( &every_step, held );
+
+    int steps = 0;
+    int reference_steps = 0;
+    while( ! timeline.empty() ) {
+      timeline.step( dt );
+      steps += 1;
+      if( ! reference.empty() ) {
+        reference.step( dt );
+        reference_steps += 1;
+      }
+    }
+    REQUIRE( throttled() == 2.0f );
+    REQUIRE( steps >= reference_steps );
+    REQUIRE( steps <= reference_steps + 6 );
+  }
+
+  SECTION( "Parallel updates honor update rates." )
+  {
+    ThreadPool pool( 2 );
+    timeline.setParallelExecutor( pool.getExecutor( 4 ) );
+    vector<Output<float>> outputs( 20 );
+    for( auto &output : outputs ) {
+      timeline.apply( &output, sequence ).updateRate( 20 );
+    }
+
+    size_t total_updated = 0;
+    for( int i = 0; i < 3; i += 1 ) {
+      timeline.step( dt );
+      total_updated += timeline.getUpdatedItemCount();
+    }
+    REQUIRE( total_updated == 20 );
+
+    while( ! timeline.empty() ) {
+      timeline.step( dt );
+    }
+    REQUIRE( std::all_of( outputs.begin(), outputs.end(), [] ( const Output<float> &o ) { return o() == 60.0f; } ) );
+  }
+}
+
+TEST_CASE( "Time Budgets" )
+{
+  Timeline timeline;
+  auto sequence = Sequence<float>( 0.0f ).then<RampTo>( 60.0f, 1.0f );
+  const float dt = 1.0f / 60.0f;
+  auto past = Deadline::fromNow( -1.0 );
+  auto future = Deadline::fromNow( 60.0 );
+
+  SECTION( "Items deferred past the deadline catch up on the next step." )
+  {
+    vector<Output<float>> outputs( 4 );
+    for( auto &output : outputs ) {
+      timeline.apply( &output, sequence );
+    }
+
+    timeline.step( dt, past );
+    auto &stats = timeline.getBudgetStats();
+    REQUIRE( stats.updated == 0 );
+    REQUIRE( stats.deferred == 4 );
+    REQUIRE( stats.overrun > 0.0 );
+    REQUIRE( stats.overrun_steps == 1 );
+    REQUIRE( outputs[0]() == 0.0f );
+
+    timeline.step( dt, future );
+    REQUIRE( stats.updated == 4 );
+    REQUIRE( stats.deferred == 0 );
+    REQUIRE( stats.overrun == 0.0 );
+    REQUIRE( stats.overrun_steps == 1 );
+    for( auto &output : outputs ) {
+      REQUIRE( output() == Approx( 2.0f ) );
+    }
+
+    // Plain steps catch up too.
+    timeline.step( dt, past );
+    timeline.step( dt );
+    REQUIRE( outputs[0]() == Approx( 4.0f ) );
+  }
+
+  SECTION( "Higher priorities step first." )
+  {
+    vector<int>           order;
+    vector<Output<float>> outputs( 3 );
+    const int priorities[] = { 0, 2, 1 };
+    for( int i = 0; i < 3; i += 1 ) {
+      timeline.apply( &outputs[i], sequence )
+        .priority( priorities[i] )
+        .startFn( [&order, i] { order.push_back( i ); } );
+    }
+
+    timeline.step( dt, future );
+    REQUIRE( order == vector<int>( { 1, 2, 0 } ) );
+  }
+
+  SECTION( "Deferred low-priority items step ahead of higher priorities next time." )
+  {
+    // Deadlines are checked every 16 items, so the first high-priority item waits out the deadline
+    // and the other fifteen still step before the rest are deferred.
+    auto deadline = Deadline::fromNow( 0.0 );
+    vector<Output<float>> high( 16 );
+    timeline.apply( &high[0], sequence ).priority( 1 ).updateFn( [&deadline] {
+      while( ! deadline.passed() ) {}
+    } );
+    for( size_t i = 1; i < high.size(); i += 1 ) {
+      timeline.apply( &high[i], sequence ).priority( 1 );
+    }
+    Output<float> low = 0.0f;
+    timeline.apply( &low, sequence );
+
+    auto &stats = timeline.getBudgetStats();
+    deadline = Deadline::fromNow( 0.05 );
+    timeline.step( dt, deadline );
+    REQUIRE( stats.deferred == 1 );
+    REQUIRE( low() == 0.0f );
+
+    deadline = Deadline::fromNow( 0.05 );
+    timeline.step( dt, deadline );
+    REQUIRE( low() == Approx( 2.0f ) );
+  }
+
+  SECTION( "Many Motions defer and catch up." )
+  {
+    vector<Output<float>> outputs( 10 );
+    for( auto &output : outputs ) {
+      timeline.apply( &output, sequence ).updateRate( 20 );
+    }
+
+    timeline.step( dt, past );
+    auto deferred = timeline.getBudgetStats().deferred;
+    auto counted = deferred + timeline.getBudgetStats().skipped;
+    REQUIRE( deferred > 0 );
+    REQUIRE( counted == 10 );
+
+    while( ! timeline.empty() ) {
+      timeline.step( dt, future );
+    }
+    REQUIRE( std::all_of( outputs.begin(), outputs.end(), [] ( const Output<float> &o ) { return o() == 60.0f; } ) );
+  }
+}
+
+TEST_CASE( "Shared Sequences" )
+{
+  Timeline timeline;
+  auto shared = std::make_shared<const Sequence<float>>( Sequence<float>( 0.0f ).then<RampTo>( 10.0f, 1.0f ) );
+  vector<Output<float>> outputs( 3 );
+
+  SECTION( "Motions play a shared Sequence without copying it until they change it." )
+  {
+    for( auto &output : outputs ) {
+      timeline.apply( &output, shared );
+    }
+    REQUIRE( shared.use_count() == 4 );
+    REQUIRE( outputs[0].inputPtr()->isSequenceShared() );
+
+    timeline.step( 0.5 );
+    REQUIRE( outputs[0]() == 5.0f );
+    REQUIRE( outputs[2]() == 5.0f );
+
+    timeline.append( &outputs[0] ).then<RampTo>( 20.0f, 1.0f );
+    timeline.append( &outputs[1] ).getMotion().cutIn( 0.25 );
+    REQUIRE_FALSE( outputs[0].inputPtr()->isSequenceShared() );
+    REQUIRE_FALSE( outputs[1].inputPtr()->isSequenceShared() );
+    REQUIRE( outputs[2].inputPtr()->isSequenceShared() );
+    REQUIRE( shared->getDuration() == 1.0 );
+    REQUIRE( shared.use_count() == 2 );
+
+    timeline.step( 1.0 );
+    REQUIRE( outputs[0]() == 15.0f );
+    REQUIRE( outputs[1]() == 7.5f );
+    REQUIRE( outputs[2]() == 10.0f );
+    REQUIRE( timeline.getDuration() == 2.0 );
+  }
+
+  SECTION( "Shared Sequences work with every kind of target and storage." )
+  {
+    timeline.setMotionStorage( MotionStorage::Bucketed );
+    OutputPool<float> pool( 1 );
+    float raw = 0;
+    timeline.apply( &outputs[0], shared );
+    timeline.apply( &pool, 0, shared );
+    timeline.applyRaw( &raw, shared );
+
+    timeline.step( 0.25 );
+    REQUIRE( outputs[0]() == 2.5f );
+    REQUIRE( pool[0] == 2.5f );
+    REQUIRE( raw == 2.5f );
+  }
+}
+
+TEST_CASE( "Pooled Allocation" )
+{
+  ch::Timeline timeline;
+  vector<Output<float>> outputs( 500 );
+  int finished = 0;
+
+  auto churn = [&] {
+    for( auto &output : outputs ) {
+      timeline.apply( &output )
+        .then<RampTo>( 10.0f, 0.25f, EaseInOutQuad() )
+        .rampTo( 5.0f, 0.25f, EaseOutCubic() )
+        .hold( 0.1f )
+        .finishFn( [&finished] { finished += 1; } )
+        .getControl();
+    }
+    timeline.cue( [] {}, 0.3f );
+    while( ! timeline.empty() ) {
+      timeline.step( 0.1f );
+    }
+  };
+
+  SECTION( "Caches keep at most MaxCachedBytes across all size classes." )
+  {
+    detail::SmallBlockCache cache;
+    vector<void*> blocks;
+    for( size_t size = 16; size <= detail::SmallBlockCache::MaxBlockSize; size += 16 ) {
+      for( int i = 0; i < 256; i += 1 ) {
+        blocks.push_back( cache.allocate( size ) );
+      }
+    }
+    size_t i = 0;
+    for( size_t size = 16; size <= detail::SmallBlockCache::MaxBlockSize; size += 16 ) {
+      for( int j = 0; j < 256; j += 1, i += 1 ) {
+        cache.deallocate( blocks[i], size );
+      }
+    }
+
+    const size_t max_cached = detail::SmallBlockCache::MaxCachedBytes;
+    REQUIRE( cache.cachedBytes() > 0 );
+    REQUIRE( cache.cachedBytes() <= max_cached );
+
+    cache.trim();
+    REQUIRE( cache.cachedBytes() == 0 );
+  }
+
+  SECTION( "Released blocks go back to the heap and are taken again when needed." )
+  {
+    churn();
+    churn();
+    REQUIRE( detail::localBlockCache()->cachedBytes() > 0 );
+
+    detail::releaseCachedBlocks();
+    REQUIRE( detail::localBlockCache()->cachedBytes() == 0 );
+
+    auto before = detail::smallHeapAllocationCount().load();
+    churn();
+    auto after = detail::smallHeapAllocationCount().load();
+
+    REQUIRE( after > before );
+  }
+
+#if defined( __cpp_aligned_new )
+  SECTION( "Over-aligned items are allocated with their alignment." )
+  {
+    struct alignas( 64 ) AlignedItem : public TimelineItem
+    {
+      void update() override {}
+      Time getDuration() const override { return 1; }
+    };
+
+    std::vector<std::unique_ptr<AlignedItem>> items;
+    for( int i = 0; i < 8; i += 1 ) {
+      items.emplace_back( new AlignedItem );
+      REQUIRE( (reinterpret_cast<uintptr_t>( items.back().get() ) % 64) == 0 );
+    }
+  }
+#endif
+}